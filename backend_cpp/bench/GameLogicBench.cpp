@@ -0,0 +1,90 @@
+#include "GameLogic.hpp"
+#include <benchmark/benchmark.h>
+#include <vector>
+
+using namespace guts;
+
+namespace {
+
+// Fixed hands covering every evaluation path
+std::vector<std::vector<Card>> sampleHands() {
+    auto deck = GameLogic::createDeck(); // ordered: 13 ranks per suit
+    return {
+        {deck[0], deck[13], deck[26]},  // three of a kind
+        {deck[0], deck[1], deck[2]},    // straight flush
+        {deck[0], deck[1], deck[15]},   // straight
+        {deck[0], deck[4], deck[9]},    // flush
+        {deck[3], deck[16], deck[30]},  // pair
+        {deck[0], deck[18], deck[36]},  // high card
+    };
+}
+
+} // namespace
+
+static void BM_CreateDeck(benchmark::State& state) {
+    for (auto _ : state) {
+        auto deck = GameLogic::createDeck();
+        benchmark::DoNotOptimize(deck.data());
+    }
+}
+BENCHMARK(BM_CreateDeck);
+
+static void BM_ShuffleDeck(benchmark::State& state) {
+    auto deck = GameLogic::createDeck();
+    for (auto _ : state) {
+        GameLogic::shuffleDeck(deck);
+        benchmark::DoNotOptimize(deck.data());
+    }
+}
+BENCHMARK(BM_ShuffleDeck);
+
+static void BM_ShuffleDeckSeeded(benchmark::State& state) {
+    auto deck = GameLogic::createDeck();
+    SeededRandom random(42);
+    for (auto _ : state) {
+        GameLogic::shuffleDeck(deck, random);
+        benchmark::DoNotOptimize(deck.data());
+    }
+}
+BENCHMARK(BM_ShuffleDeckSeeded);
+
+// Deal three cards to each of N players from a fresh deck
+static void BM_DealCards(benchmark::State& state) {
+    const auto players = static_cast<size_t>(state.range(0));
+    const auto fresh = GameLogic::createDeck();
+    for (auto _ : state) {
+        auto deck = fresh;
+        for (size_t i = 0; i < players; ++i) {
+            auto hand = GameLogic::dealCards(deck, 3);
+            benchmark::DoNotOptimize(hand.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(players));
+}
+BENCHMARK(BM_DealCards)->DenseRange(2, 8, 2);
+
+static void BM_EvaluateHand(benchmark::State& state) {
+    const auto hands = sampleHands();
+    const bool nothingRound = state.range(0) != 0;
+    size_t i = 0;
+    for (auto _ : state) {
+        auto evaluation = GameLogic::evaluateHand(hands[i++ % hands.size()], nothingRound);
+        benchmark::DoNotOptimize(evaluation);
+    }
+}
+BENCHMARK(BM_EvaluateHand)->ArgName("nothingRound")->Arg(0)->Arg(1);
+
+static void BM_CompareHands(benchmark::State& state) {
+    std::vector<HandEvaluation> evaluations;
+    for (const auto& hand : sampleHands()) {
+        evaluations.push_back(GameLogic::evaluateHand(hand));
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& a = evaluations[i % evaluations.size()];
+        const auto& b = evaluations[(i + 1) % evaluations.size()];
+        benchmark::DoNotOptimize(GameLogic::compareHands(a, b));
+        ++i;
+    }
+}
+BENCHMARK(BM_CompareHands);
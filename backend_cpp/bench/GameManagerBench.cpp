@@ -0,0 +1,139 @@
+#include "GameManager.hpp"
+#include "VirtualScheduler.hpp"
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace guts;
+using nlohmann::json;
+
+namespace {
+
+// A started room of N players on a virtual clock. Outbound messages are
+// serialized like the WebSocket layer does so fan-out cost is included.
+struct BenchRoom {
+    VirtualScheduler scheduler;
+    std::unique_ptr<GameManager> manager;
+    std::vector<std::string> sockets;
+    size_t bytesOut = 0;
+    const std::string roomCode = "BENCH1";
+
+    explicit BenchRoom(int players) {
+        auto serialize = [this](const std::string&, const std::string& event, const json& data) {
+            bytesOut += json{{"event", event}, {"data", data}}.dump().size();
+        };
+        manager = std::make_unique<GameManager>(serialize, serialize, scheduler.callback());
+        manager->setRandomSeed(42);
+        manager->createGame(roomCode, "token-0");
+
+        for (int i = 0; i < players; ++i) {
+            sockets.push_back("socket-" + std::to_string(i));
+            manager->handleJoinRoom(sockets.back(), {
+                {"roomCode", roomCode},
+                {"playerToken", "token-" + std::to_string(i)},
+                {"playerName", "Player " + std::to_string(i)}
+            });
+        }
+        manager->handleStartGame(sockets[0], json::object());
+        scheduler.advance(3.0); // first deal, round_started, first tick
+    }
+
+    // Keep everyone solvent so rounds never block on debt
+    void refill() {
+        Game* game = manager->getGame(roomCode);
+        game->pot = 0.0;
+        for (auto& p : game->players) {
+            p.balance = 1000.0;
+            p.isActive = true;
+        }
+    }
+};
+
+void addPlayers(Game& game, int players) {
+    for (int i = 0; i < players; ++i) {
+        Player player;
+        player.id = "player-" + std::to_string(i);
+        player.token = "token-" + std::to_string(i);
+        player.name = "Player " + std::to_string(i);
+        player.balance = 20.0;
+        player.buyInAmount = 20.0;
+        player.isHost = i == 0;
+        player.isActive = true;
+        player.socketId = "socket-" + std::to_string(i);
+        game.players.push_back(player);
+    }
+}
+
+json roundStartedMessage(int players) {
+    Game game("BENCH1", "token-0");
+    addPlayers(game, players);
+    return {
+        {"round", 4},
+        {"pot", 12.5},
+        {"isNothingRound", false},
+        {"players", game.publicSnapshot().players}
+    };
+}
+
+} // namespace
+
+// Decisions from every player through resolution, the two-holder showdown
+// and the next deal (all animation delays skipped on the virtual clock)
+static void BM_FullRound(benchmark::State& state) {
+    const int players = static_cast<int>(state.range(0));
+    BenchRoom room(players);
+
+    for (auto _ : state) {
+        room.refill();
+        for (int i = 0; i < players; ++i) {
+            room.manager->handlePlayerDecision(room.sockets[i], {{"decision", i < 2 ? "hold" : "drop"}});
+        }
+        room.scheduler.runUntilIdle();
+        room.manager->handleNextRound(room.sockets[0], json::object());
+        room.scheduler.advance(1.0);
+    }
+
+    state.counters["bytesOutPerRound"] = benchmark::Counter(
+        static_cast<double>(room.bytesOut), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_FullRound)->ArgName("players")->DenseRange(2, 8, 1);
+
+static void BM_SerializeRoundStarted(benchmark::State& state) {
+    const json data = roundStartedMessage(static_cast<int>(state.range(0)));
+    size_t bytes = 0;
+    for (auto _ : state) {
+        std::string wire = json{{"event", "round_started"}, {"data", data}}.dump();
+        bytes += wire.size();
+        benchmark::DoNotOptimize(wire.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_SerializeRoundStarted)->ArgName("players")->DenseRange(2, 8, 2);
+
+static void BM_SerializeCardsDealt(benchmark::State& state) {
+    auto deck = GameLogic::createDeck();
+    json cards = json::array();
+    for (const auto& card : GameLogic::dealCards(deck, 3)) {
+        cards.push_back(card.toJson());
+    }
+    const json data = {{"cards", cards}, {"round", 4}, {"isNothingRound", false}, {"playerId", "player-0"}};
+
+    for (auto _ : state) {
+        std::string wire = json{{"event", "cards_dealt"}, {"data", data}}.dump();
+        benchmark::DoNotOptimize(wire.data());
+    }
+}
+BENCHMARK(BM_SerializeCardsDealt);
+
+// Public room snapshot rebuilt after a state change
+static void BM_PublicSnapshotRebuild(benchmark::State& state) {
+    Game game("BENCH1", "token-0");
+    addPlayers(game, static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        game.markDirty();
+        benchmark::DoNotOptimize(game.serializedSnapshot().data());
+    }
+}
+BENCHMARK(BM_PublicSnapshotRebuild)->ArgName("players")->DenseRange(2, 8, 2);
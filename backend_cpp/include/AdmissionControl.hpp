@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace guts {
+
+// Turns new work away before the process runs out of headroom. A timer
+// feeds it load signals; request handlers only read an atomic level, so
+// the check costs nothing on the hot path. Creating a room is shed first,
+// then joining one as a new player. Players already seated in a room are
+// never refused, so running games keep their latency.
+class AdmissionController {
+public:
+    enum class Level : int {
+        Normal,
+        ShedCreates,
+        ShedJoins
+    };
+
+    // Zero disables a limit. Creates are shed at a limit, new joins at
+    // `joinFactor` times it (room count only ever sheds creates).
+    struct Limits {
+        double lagMs = 100.0;       // smoothed lag of the worst event loop
+        size_t rooms = 0;           // live and hibernated rooms
+        uint64_t rssBytes = 0;      // resident set size
+        size_t queueDepth = 100000; // records waiting for background writers
+        double joinFactor = 2.5;
+        int retryAfterSeconds = 5;
+    };
+
+    struct Signals {
+        double lagMs = 0;
+        size_t rooms = 0;
+        uint64_t rssBytes = 0;
+        size_t queueDepth = 0;
+    };
+
+    explicit AdmissionController(Limits limits);
+
+    // Re-evaluate from fresh signals. Raising the level is immediate;
+    // dropping it waits until every signal is well under its limit.
+    // Call from one thread.
+    void update(const Signals& signals);
+
+    Level level() const { return static_cast<Level>(level_.load(std::memory_order_relaxed)); }
+
+    // False (and counted) when the request should get a 503
+    bool admitCreate();
+    bool admitJoin();
+
+    int retryAfterSeconds() const { return limits_.retryAfterSeconds; }
+
+    // guts_admission_* level, signals and shed counts
+    void renderPrometheus(std::string& out) const;
+
+    // Resident set size from /proc/self/statm; 0 where unavailable
+    static uint64_t residentBytes();
+
+private:
+    Level pressure(const Signals& signals, double scale) const;
+
+    Limits limits_;
+    std::atomic<int> level_{static_cast<int>(Level::Normal)};
+    std::atomic<uint64_t> shedCreates_{0};
+    std::atomic<uint64_t> shedJoins_{0};
+    std::atomic<size_t> rooms_{0};
+    std::atomic<uint64_t> rssBytes_{0};
+    std::atomic<size_t> queueDepth_{0};
+};
+
+const char* admissionLevelName(AdmissionController::Level level);
+
+} // namespace guts
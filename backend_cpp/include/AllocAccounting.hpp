@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace guts {
+namespace alloc {
+
+struct AllocStats {
+    uint64_t scopes = 0;      // times a scope with this tag was entered
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t bytes = 0;       // requested bytes, not counting frees
+};
+
+struct TaggedStats {
+    const char* tag;
+    AllocStats stats;
+};
+
+#ifdef GUTS_ALLOC_ACCOUNTING
+
+// With -DGUTS_ALLOC_ACCOUNTING=ON the global operator new/delete count every
+// allocation in a per-thread slot, attributed to the innermost AllocScope
+// on that thread ("untagged" outside of any). Tags must be string literals.
+class AllocScope {
+public:
+    explicit AllocScope(const char* tag);
+    ~AllocScope();
+
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+private:
+    size_t previous_;
+};
+
+// Current thread, all tags
+AllocStats threadTotals();
+
+// Summed over all threads, one entry per tag seen so far
+std::vector<TaggedStats> totalsByTag();
+
+// guts_alloc_total / guts_alloc_bytes_total by tag
+void renderPrometheus(std::string& out);
+
+#else
+
+class AllocScope {
+public:
+    explicit AllocScope(const char*) {}
+};
+
+inline AllocStats threadTotals() { return {}; }
+inline std::vector<TaggedStats> totalsByTag() { return {}; }
+inline void renderPrometheus(std::string&) {}
+
+#endif
+
+} // namespace alloc
+} // namespace guts
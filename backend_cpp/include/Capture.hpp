@@ -0,0 +1,66 @@
+#pragma once
+
+#include "MpscQueue.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+#include <cstdint>
+
+namespace guts {
+
+// One inbound event as the server saw it. `message` is the raw WebSocket
+// text; the pseudo-events "create_room" (message: {"roomCode","hostToken"})
+// and "disconnect" (empty message) cover what arrives outside /ws.
+struct CaptureEvent {
+    uint64_t offsetMicros = 0; // since the capture started
+    std::string socketId;
+    std::string event;
+    std::string message;
+};
+
+// Records inbound traffic to a binary file for guts_replay. record() pushes
+// onto a lock-free queue; a writer thread appends to the file. The file
+// holds tokens, so treat it like a credential store.
+//
+// File: "GCAP1" [u64 start, unix ms] then [u32 length][record] per event,
+// record = [u64 offset us][str socketId][str event][str message].
+class CaptureRecorder {
+public:
+    // Stops recording once the file reaches `maxBytes`
+    CaptureRecorder(const std::string& path, uint64_t maxBytes);
+    ~CaptureRecorder();
+
+    CaptureRecorder(const CaptureRecorder&) = delete;
+    CaptureRecorder& operator=(const CaptureRecorder&) = delete;
+
+    // Any thread; never blocks
+    void record(const std::string& socketId, const std::string& event, const std::string& message);
+
+    void stop();
+
+    uint64_t recorded() const { return recorded_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    bool drain();
+
+    std::FILE* file_;
+    uint64_t maxBytes_;
+    uint64_t bytes_ = 0;
+    std::chrono::steady_clock::time_point started_;
+    MpscQueue<CaptureEvent> queue_;
+    std::atomic<bool> full_{false};
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint64_t> recorded_{0};
+    std::thread writer_;
+};
+
+// Visit the events of a capture in order; `startUnixMs` is set from the
+// header. Returns false if the file is missing or not a capture.
+bool readCapture(const std::string& path, uint64_t& startUnixMs,
+                 const std::function<void(const CaptureEvent&)>& visit);
+
+} // namespace guts
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace guts {
+
+// Room codes name the node that minted them: the first kNodeTagLength
+// characters are a tag derived from the node id. Ownership is read off the
+// code, so adding or removing nodes never moves an existing room; the
+// membership file only says which tags are reachable and where.
+constexpr size_t kNodeTagLength = 2;
+
+// `nodeId`'s tag, in the room code alphabet; stable across builds
+std::string nodeTag(const std::string& nodeId);
+
+struct ClusterNode {
+    std::string id;
+    std::string url;     // public base URL, e.g. http://10.0.0.5:3001
+    std::string tag;     // nodeTag(id)
+};
+
+// "nodeId url" per line; blank lines and # comments are skipped. Throws
+// std::runtime_error if the file can't be read, a line is malformed or two
+// nodes would share a tag.
+std::vector<ClusterNode> loadClusterFile(const std::string& path);
+
+// http(s)://host -> ws(s)://host/ws
+std::string webSocketUrl(const std::string& url);
+
+// This node's view of the membership file shared by all nodes. Thread-safe.
+class ClusterMembership {
+public:
+    // Throws like loadClusterFile, or if `selfId` isn't in the file
+    ClusterMembership(std::string path, std::string selfId);
+
+    // Re-read the file if it changed. A broken file keeps the old members.
+    // Returns true when the members changed. Call from one thread.
+    bool reload();
+
+    // Every code this node mints starts with it
+    const std::string& codePrefix() const { return selfTag_; }
+
+    // Base URL of the node that minted `roomCode`; empty when it's this one
+    // or a node no longer listed
+    std::string remoteOwner(const std::string& roomCode) const;
+
+    const std::string& selfId() const { return selfId_; }
+    std::string selfWebSocketUrl() const;
+    size_t nodeCount() const;
+
+private:
+    std::shared_ptr<const std::vector<ClusterNode>> nodes() const;
+    void install(std::vector<ClusterNode> nodes);
+
+    std::string path_;
+    std::string selfId_;
+    std::string selfTag_;
+    std::chrono::system_clock::time_point loadedMtime_;
+    mutable std::mutex mutex_;
+    std::shared_ptr<const std::vector<ClusterNode>> nodes_;
+};
+
+} // namespace guts
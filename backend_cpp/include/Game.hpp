@@ -2,11 +2,15 @@
 
 #include "Player.hpp"
 #include "Card.hpp"
+#include "RoomEventLog.hpp"
+#include "RandomSource.hpp"
 #include <string>
 #include <vector>
 #include <map>
 #include <memory>
 #include <chrono>
+#include <cstdint>
+#include <nlohmann/json.hpp>
 
 namespace guts {
 
@@ -16,6 +20,27 @@ enum class GameState {
     ENDED
 };
 
+inline const char* getGameStateName(GameState state) {
+    switch (state) {
+        case GameState::LOBBY: return "lobby";
+        case GameState::PLAYING: return "playing";
+        case GameState::ENDED: return "ended";
+    }
+    return "unknown";
+}
+
+// Public room state shared by every player, cached per Game::version
+struct RoomSnapshot {
+    uint64_t version = 0;
+    bool built = false;
+    nlohmann::json players;     // array of Player::toJson()
+    nlohmann::json state;       // state, round, pot, isNothingRound
+    std::string playersText;    // `players` as text
+    std::string serialized;     // {"players":..., "state":...} as text
+    bool playersTextBuilt = false;
+    bool serializedBuilt = false;
+};
+
 struct Game {
     std::string roomCode;
     std::string hostToken;
@@ -31,12 +56,69 @@ struct Game {
     std::chrono::system_clock::time_point lastActivity;
     bool isNothingRound;
     bool pendingGameEnd;
+    bool roundResolved;    // set once the current round's decisions are settled
+    bool roundInFlight = false; // antes collected, result not yet paid out
+    std::map<std::string, double> roundStartBalances; // playerId -> balance before the ante
+    std::chrono::steady_clock::time_point decisionDeadline;
+    std::chrono::steady_clock::time_point roundStartedAt; // for the round trace span
+    RoomEventLog eventLog; // recent outbound events for reconnect resume
+    uint64_t version;      // bumped around every handler and room timer
+    size_t pendingTimers = 0; // scheduled tasks for this room that haven't run
+    std::unique_ptr<RandomSource> random; // shuffles and player IDs for this room
     
     Game(const std::string& code, const std::string& host)
         : roomCode(code), hostToken(host), state(GameState::LOBBY),
           buyInAmount(20.0), ante(0.50), pot(0.0), round(0),
           lastActivity(std::chrono::system_clock::now()),
-          isNothingRound(true), pendingGameEnd(false) {}
+          isNothingRound(true), pendingGameEnd(false), roundResolved(true),
+          version(1) {}
+    
+    void markDirty() { ++version; }
+    
+    // Public room state, rebuilt only when the version has moved on
+    const RoomSnapshot& publicSnapshot() {
+        if (!snapshot_.built || snapshot_.version != version) {
+            snapshot_.players = nlohmann::json::array();
+            for (const auto& player : players) {
+                snapshot_.players.push_back(player.toJson());
+            }
+            snapshot_.state = {
+                {"state", getGameStateName(state)},
+                {"round", round},
+                {"pot", pot},
+                {"isNothingRound", isNothingRound}
+            };
+            snapshot_.version = version;
+            snapshot_.built = true;
+            snapshot_.playersTextBuilt = false;
+            snapshot_.serializedBuilt = false;
+        }
+        return snapshot_;
+    }
+    
+    // The public player array already serialized, for messages that carry
+    // it to every joiner
+    const std::string& serializedPlayers() {
+        publicSnapshot();
+        if (!snapshot_.playersTextBuilt) {
+            snapshot_.playersText = snapshot_.players.dump();
+            snapshot_.playersTextBuilt = true;
+        }
+        return snapshot_.playersText;
+    }
+    
+    // The snapshot as last built, without rebuilding it
+    const RoomSnapshot& cachedSnapshot() const { return snapshot_; }
+    
+    // Serialized form of publicSnapshot() for read-only endpoints
+    const std::string& serializedSnapshot() {
+        const std::string& players = serializedPlayers();
+        if (!snapshot_.serializedBuilt) {
+            snapshot_.serialized = "{\"players\":" + players + ",\"state\":" + snapshot_.state.dump() + "}";
+            snapshot_.serializedBuilt = true;
+        }
+        return snapshot_.serialized;
+    }
     
     Player* findPlayerById(const std::string& playerId) {
         for (auto& player : players) {
@@ -66,6 +148,19 @@ struct Game {
         }
         return active;
     }
+    
+    // True once every active player has a recorded decision
+    bool allActivePlayersDecided() const {
+        for (const auto& player : players) {
+            if (player.isActive && decisions.find(player.id) == decisions.end()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    RoomSnapshot snapshot_;
 };
 
 } // namespace guts
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Game.hpp"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <cstdint>
+#include <cstring>
+
+namespace guts {
+
+// Little-endian append-only encoder for compact binary records
+class BinaryWriter {
+public:
+    explicit BinaryWriter(std::string& out) : out_(out) {}
+
+    void u8(uint8_t value) { out_.push_back(static_cast<char>(value)); }
+
+    void u32(uint32_t value) {
+        for (int i = 0; i < 4; ++i) u8(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    void u64(uint64_t value) {
+        for (int i = 0; i < 8; ++i) u8(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    void i64(int64_t value) { u64(static_cast<uint64_t>(value)); }
+
+    void f64(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        u64(bits);
+    }
+
+    void str(const std::string& value) {
+        u32(static_cast<uint32_t>(value.size()));
+        out_.append(value);
+    }
+
+private:
+    std::string& out_;
+};
+
+// Bounds-checked decoder; throws std::runtime_error on truncated input
+class BinaryReader {
+public:
+    BinaryReader(const char* data, size_t size) : data_(data), size_(size) {}
+
+    uint8_t u8() {
+        need(1);
+        return static_cast<uint8_t>(data_[pos_++]);
+    }
+
+    uint32_t u32() {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) value |= static_cast<uint32_t>(u8()) << (8 * i);
+        return value;
+    }
+
+    uint64_t u64() {
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) value |= static_cast<uint64_t>(u8()) << (8 * i);
+        return value;
+    }
+
+    int64_t i64() { return static_cast<int64_t>(u64()); }
+
+    double f64() {
+        uint64_t bits = u64();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    std::string str() {
+        uint32_t length = u32();
+        need(length);
+        std::string value(data_ + pos_, length);
+        pos_ += length;
+        return value;
+    }
+
+    void skip(size_t bytes) {
+        need(bytes);
+        pos_ += bytes;
+    }
+
+    size_t position() const { return pos_; }
+    size_t remaining() const { return size_ - pos_; }
+
+private:
+    void need(size_t bytes) const {
+        if (size_ - pos_ < bytes) throw std::runtime_error("Truncated binary record");
+    }
+
+    const char* data_;
+    size_t size_;
+    size_t pos_ = 0;
+};
+
+// Cards as (value, suit) byte pairs behind a u32 count
+void writeCards(BinaryWriter& out, const std::vector<Card>& cards);
+std::vector<Card> readCards(BinaryReader& in);
+
+// Binary image of a room's durable state: players and their money, the
+// round in progress (deck, hands, decisions) and the event log position.
+// Sockets, timers, snapshots and the random source are not part of it.
+std::string encodeGame(const Game& game);
+
+// Inverse of encodeGame; throws std::runtime_error on malformed input.
+// The returned game has no random source yet.
+std::unique_ptr<Game> decodeGame(const std::string& blob);
+
+} // namespace guts
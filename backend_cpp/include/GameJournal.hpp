@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+namespace guts {
+
+// Crash-safe room storage: an append-only write-ahead log plus periodic
+// snapshots in one directory. Records are whole room images (GameCodec)
+// tagged with the event that produced them, so recovery is last-write-wins
+// per room and never re-runs game logic.
+//
+// append() only queues. A background writer drains the queue with one
+// write() and one fdatasync() per batch (group commit), so event loops
+// never wait on the disk; a crash can lose the batch being written. The
+// writer also keeps the latest image of every room, which lets it write a
+// snapshot and truncate the log without touching the event loops.
+class GameJournal {
+public:
+    struct Options {
+        std::string directory;
+        bool sync = true;                          // fdatasync every batch
+        double snapshotIntervalSeconds = 300.0;
+        uint64_t snapshotLogBytes = 64ull << 20;   // or once the log is this big
+    };
+
+    explicit GameJournal(Options options);
+    ~GameJournal();
+
+    GameJournal(const GameJournal&) = delete;
+    GameJournal& operator=(const GameJournal&) = delete;
+
+    // Room images on disk: the snapshot, then the log on top. A torn record
+    // at the end of the log (crash mid-write) ends the replay and is cut
+    // off. Call once, before start().
+    std::map<std::string, std::string> recover();
+
+    void start();
+
+    // Drain the queue, write a final snapshot and stop the writer
+    void stop();
+
+    // Queue a room image; an empty blob records that the room is gone.
+    // Thread-safe. `reason` must be a string literal.
+    void append(const std::string& roomCode, std::string blob, const char* reason);
+
+    size_t queueDepth() const { return queueDepth_.load(std::memory_order_relaxed); }
+
+    // guts_journal_* counters and queue depth
+    void renderPrometheus(std::string& out) const;
+
+private:
+    struct Pending {
+        std::string roomCode;
+        std::string blob;
+        const char* reason;
+    };
+
+    void run();
+    void writeBatch(std::vector<Pending>& batch);
+    void writeSnapshot();
+    bool readRecords(const std::string& path, bool truncateTornTail);
+
+    std::string logPath() const;
+    std::string snapshotPath() const;
+
+    Options options_;
+    int logFd_ = -1;
+    uint64_t logBytes_ = 0;
+    bool snapshotOwed_ = false; // a failed log write left records only in latest_
+    std::chrono::steady_clock::time_point lastSnapshot_;
+    std::map<std::string, std::string> latest_; // writer thread (and recover())
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<Pending> pending_;
+    bool stopping_ = false;
+    std::thread writer_;
+
+    std::atomic<size_t> queueDepth_{0};
+    std::atomic<uint64_t> records_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> snapshots_{0};
+    std::atomic<uint64_t> errors_{0};
+};
+
+} // namespace guts
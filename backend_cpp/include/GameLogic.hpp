@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Card.hpp"
+#include "RandomSource.hpp"
 #include <vector>
 #include <algorithm>
 #include <random>
@@ -15,6 +16,9 @@ public:
     // Shuffle deck using cryptographically secure random
     static void shuffleDeck(std::vector<Card>& deck);
     
+    // Shuffle deck with the given source (e.g. a room's seeded source)
+    static void shuffleDeck(std::vector<Card>& deck, RandomSource& source);
+    
     // Deal specified number of cards from deck
     static std::vector<Card> dealCards(std::vector<Card>& deck, size_t count);
     
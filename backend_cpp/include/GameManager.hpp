@@ -2,23 +2,66 @@
 
 #include "Game.hpp"
 #include "GameLogic.hpp"
+#include "HandHistory.hpp"
+#include "PlayerStats.hpp"
 #include <map>
 #include <memory>
 #include <string>
 #include <functional>
+#include <chrono>
+#include <array>
 #include <nlohmann/json.hpp>
 
 namespace guts {
 
 using MessageCallback = std::function<void(const std::string& socketId, const std::string& event, const nlohmann::json& data)>;
 using BroadcastCallback = std::function<void(const std::string& roomCode, const std::string& event, const nlohmann::json& data)>;
+// MessageCallback with `data` already serialized, so cached snapshot text
+// goes out without being rebuilt as JSON
+using RawMessageCallback = std::function<void(const std::string& socketId, const std::string& event, const std::string& data)>;
+using ScheduleCallback = std::function<void(double delaySeconds, std::function<void()> task)>;
+// Durable state changes, for the write-ahead log. `game` is null when the
+// room was removed; `reason` names the event that caused the change.
+using JournalCallback = std::function<void(const std::string& roomCode, const Game* game, const char* reason)>;
+// Every resolved round, for the hand history
+using HandHistoryCallback = std::function<void(HandRecord&& record)>;
+// Per-player round and game results, for lifetime stats
+using PlayerStatsCallback = std::function<void(PlayerStatsUpdate&& update)>;
+
+// One room as listed by /api/admin/rooms. Byte counts are estimates of the
+// heap a room holds, from container capacities and libstdc++ node sizes.
+// Socket traffic is not room state; the server adds it from its own counts.
+struct RoomSummary {
+    std::string roomCode;
+    GameState state = GameState::LOBBY;
+    int round = 0;
+    size_t players = 0;
+    size_t connected = 0;       // players with a live socket
+    double pot = 0;
+    std::chrono::system_clock::time_point lastActivity;
+    bool hibernated = false;
+    size_t pendingTimers = 0;
+    size_t gameBytes = 0;       // the Game and what it owns, or the hibernated blob
+    size_t timerBytes = 0;      // scheduled tasks waiting in the event loop
+    size_t eventLogBytes = 0;   // recent outbound events kept for resume
+    
+    size_t totalBytes() const { return gameBytes + timerBytes + eventLogBytes; }
+};
+
+// A GameManager is single-threaded: every handler call and every scheduled
+// task for its rooms must run on the same thread (the event loop passed in
+// through ScheduleCallback). Run several managers to use several cores.
 
 class GameManager {
 public:
-    GameManager(MessageCallback msgCallback, BroadcastCallback broadcastCallback);
+    GameManager(MessageCallback msgCallback, BroadcastCallback broadcastCallback,
+                ScheduleCallback scheduleCallback = nullptr);
     
     // Game management
-    std::string generateRoomCode();
+    // `accept` can restrict the code space (e.g. codes owned by this manager);
+    // `prefix` fixes the leading characters (e.g. the cluster node's tag)
+    std::string generateRoomCode(const std::function<bool(const std::string&)>& accept = nullptr,
+                                 const std::string& prefix = std::string());
     void createGame(const std::string& roomCode, const std::string& hostToken);
     Game* getGame(const std::string& roomCode);
     
@@ -34,23 +77,143 @@ public:
     void handleDisconnect(const std::string& socketId);
     void handlePlayerEmote(const std::string& socketId, const nlohmann::json& data);
     
+    // Route an inbound WebSocket event to its handler by name ("disconnect"
+    // included). Returns false for unknown events.
+    bool handleEvent(const std::string& socketId, const std::string& event, const nlohmann::json& data);
+    
     // Cleanup
     void cleanupAbandonedGames();
+    
+    // Cold storage: a room with nobody connected or reconnecting, no round
+    // in flight and no activity for `idleFor` is kept only as its GameCodec
+    // blob. getGame() wakes it, so joins see no difference. Returns the
+    // number of rooms put to sleep.
+    size_t hibernateIdleRooms(std::chrono::seconds idleFor);
+    size_t hibernatedCount() const { return hibernated_.size(); }
+    size_t roomCount() const { return games_.size() + hibernated_.size(); }
+    
+    // Every room this manager holds, hibernated ones included
+    std::vector<RoomSummary> summarizeRooms() const;
+    
+    // Live rooms indexed by GameState (hibernated rooms are not counted)
+    std::array<size_t, 3> countRoomsByState() const;
+    
+    // How long a player who drops mid-round keeps their seat in the round
+    void setDisconnectGrace(std::chrono::milliseconds grace) { disconnectGrace_ = grace; }
+    
+    // Deterministic mode: room codes come from `seed` and every room created
+    // afterwards gets its own source derived from the seed and its code, so a
+    // scripted session replays identically. Without it rooms use SecureRandom.
+    void setRandomSeed(uint64_t seed);
+    // Separate seeds for room codes and for rooms, so several managers can
+    // draw distinct codes while a room's deals depend only on `roomSeed` and
+    // its code (what guts_replay --seed reproduces)
+    void setRandomSeed(uint64_t codeSeed, uint64_t roomSeed);
+    
+    // Without it raw messages are parsed back and go through MessageCallback
+    void setRawMessage(RawMessageCallback rawMessage) { sendRawMessage_ = std::move(rawMessage); }
+    void setJournal(JournalCallback journal) { journal_ = std::move(journal); }
+    void setHandHistory(HandHistoryCallback handHistory) { handHistory_ = std::move(handHistory); }
+    void setPlayerStats(PlayerStatsCallback playerStats) { playerStats_ = std::move(playerStats); }
+    
+    // Adopt a room decoded from disk. A round that was in flight is voided:
+    // antes go back to the players and the host deals again.
+    void restoreGame(std::unique_ptr<Game> game);
+    
+    // For a hot restart: stop handling events and firing timers, so the
+    // rooms stay exactly as exported while another process takes over
+    void freeze() { frozen_ = true; }
+    bool frozen() const { return frozen_; }
+    
+    // Every room, hibernated ones included, encoded with GameCodec
+    std::vector<std::pair<std::string, std::string>> exportRooms() const;
+    
+    static constexpr int kDecisionSeconds = 30;
 
 private:
     void startNewRound(Game* game);
     void startDecisionTimer(Game* game);
+    void decisionTick(const std::string& roomCode, int roundNumber, int remaining);
     void resolveRound(Game* game);
     void handleMultipleHolders(Game* game, const std::vector<Player*>& holders);
     void handleDeckShowdown(Game* game, Player* holder);
     void endGame(Game* game);
+    void expireDisconnectGrace(Game* game);
+    void runAfter(double delaySeconds, std::function<void()> task);
+    // runAfter for a room's own timers, counted in Game::pendingTimers
+    void runForRoom(Game* game, double delaySeconds, std::function<void()> task);
+    
+    // runAfter for the designed pauses of a round, traced as a span so
+    // scheduler lateness shows up as excess over the designed delay
+    void runPhaseAfter(Game* game, const char* phase, double delaySeconds, std::function<void()> task);
+    void finishRoundTrace(Game* game);
+    
+    struct HibernatedRoom {
+        std::string blob;
+        RoomSummary summary; // as the room was put to sleep
+    };
+    RoomSummary summarize(const Game& game) const;
+    Game* wake(std::map<std::string, HibernatedRoom>::iterator it);
+    // getGame without waking a hibernated room; timers use it, since a room
+    // that was put to sleep has nothing scheduled
+    Game* awakeGame(const std::string& roomCode);
+    void forgetHibernated(std::map<std::string, HibernatedRoom>::iterator it);
+    void attachRandomSource(Game* game);
+    
+    void journal(const Game* game, const char* reason);
+    void journalRemoved(const std::string& roomCode, const char* reason);
+    // A resolved round, for the hand history and lifetime stats
+    void recordHand(Game* game, HandOutcome outcome, double potBefore, const std::string& winnerId,
+                    std::vector<Card> deckCards = {});
+    
+    // Outbound room events are sequence-numbered and logged for resume
+    void broadcastEvent(Game* game, const std::string& event, nlohmann::json data);
+    void sendPlayerEvent(Game* game, const Player& player, const std::string& event, nlohmann::json data);
+    // `data` plus the room's serialized public players, to one socket
+    void sendWithPlayers(const std::string& socketId, const std::string& event, const nlohmann::json& data,
+                         Game* game);
+    // The current round's timer_started, with the time left to decide
+    void sendRemainingTimer(const std::string& socketId, const Game* game);
+    
+    // Brackets one handler or room timer. A path that goes on to change
+    // public room state calls modified() first; the room's cached snapshot
+    // is dropped then, so later reads in the handler see the change, and
+    // once more on the way out in case anything changed after such a read.
+    // Rejected and no-op requests leave the snapshot cached.
+    class RoomMutation {
+    public:
+        RoomMutation(GameManager& manager, Game* game);
+        ~RoomMutation();
+        RoomMutation(const RoomMutation&) = delete;
+        RoomMutation& operator=(const RoomMutation&) = delete;
+        
+        void markModified() { modified_ = true; }
+    private:
+        GameManager& manager_;
+        RoomMutation* outer_;
+        std::string roomCode_;
+        bool modified_ = false;
+    };
+    void modified(Game* game);
     
     std::map<std::string, std::unique_ptr<Game>> games_;
+    std::map<std::string, HibernatedRoom> hibernated_;
     std::map<std::string, std::string> socketToPlayerId_; // socketId -> playerId
     std::map<std::string, std::string> socketToRoomCode_; // socketId -> roomCode
+    RoomMutation* mutation_ = nullptr; // innermost open RoomMutation
     
     MessageCallback sendMessage_;
     BroadcastCallback broadcastToRoom_;
+    RawMessageCallback sendRawMessage_;
+    ScheduleCallback schedule_;
+    JournalCallback journal_;
+    HandHistoryCallback handHistory_;
+    PlayerStatsCallback playerStats_;
+    std::chrono::milliseconds disconnectGrace_{8000};
+    std::unique_ptr<RandomSource> random_; // room codes
+    bool seeded_ = false;
+    uint64_t seed_ = 0;
+    bool frozen_ = false;
 };
 
 } // namespace guts
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "Card.hpp"
+#include "MpscQueue.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+namespace guts {
+
+enum class HandOutcome : uint8_t {
+    AllDropped = 1,
+    MultipleHolders = 2,
+    DeckWin = 3,   // single holder beat the deck
+    DeckLoss = 4   // single holder matched the pot
+};
+
+const char* getHandOutcomeName(HandOutcome outcome);
+
+struct HandRecordPlayer {
+    std::string id;
+    std::string name;
+    std::vector<Card> cards;
+    std::string decision;       // "hold" or "drop"
+    double balanceBefore = 0;   // before the ante
+    double balanceAfter = 0;
+    int handType = 0;           // HandType, filled in by the writer
+};
+
+// One resolved round, as needed to settle a dispute
+struct HandRecord {
+    std::string roomCode;
+    int round = 0;
+    int64_t timestampMs = 0;
+    bool isNothingRound = false;
+    HandOutcome outcome = HandOutcome::AllDropped;
+    double ante = 0;
+    double potBefore = 0;       // at resolution, before any payout
+    double potAfter = 0;
+    std::string winnerId;
+    std::vector<Card> deckCards; // single holder rounds only
+    int deckHandType = 0;
+    std::vector<HandRecordPlayer> players; // everyone dealt in
+};
+
+// Asynchronous, compressed hand-history log. record() only moves the record
+// onto a lock-free queue; a writer thread evaluates the hands, encodes the
+// records, deflates them in blocks and appends the blocks to segment files
+// that rotate by size and age.
+//
+// Segment: "GHH1", then blocks of [u32 raw length][u32 compressed length]
+// [u32 crc32 of compressed][zlib data]. A block holds [u32 length][record].
+class HandHistory {
+public:
+    struct Options {
+        std::string directory;
+        uint64_t segmentBytes = 64ull << 20;
+        double segmentSeconds = 3600.0;
+        size_t blockBytes = 64 << 10;
+        double flushSeconds = 1.0;     // longest a record sits in memory
+        size_t maxQueued = 100000;     // beyond this, records are dropped
+    };
+
+    explicit HandHistory(Options options);
+    ~HandHistory();
+
+    HandHistory(const HandHistory&) = delete;
+    HandHistory& operator=(const HandHistory&) = delete;
+
+    void start();
+
+    // Write everything queued so far and stop the writer
+    void stop();
+
+    // Any thread; never blocks
+    void record(HandRecord record);
+
+    size_t queueDepth() const { return queued_.load(std::memory_order_relaxed); }
+
+    void renderPrometheus(std::string& out) const;
+
+private:
+    void run();
+    bool drain();
+    void flushBlock();
+    void openSegment();
+    void closeSegment();
+
+    Options options_;
+    MpscQueue<HandRecord> queue_;
+    std::atomic<size_t> queued_{0};
+    std::atomic<bool> stopping_{false};
+    std::thread writer_;
+
+    // Writer thread only
+    std::string block_;
+    size_t blockRecords_ = 0;
+    std::chrono::steady_clock::time_point blockStarted_;
+    int segmentFd_ = -1;
+    uint64_t segmentBytes_ = 0;
+    std::chrono::steady_clock::time_point segmentOpened_;
+    uint64_t segmentIndex_ = 0;
+
+    std::atomic<uint64_t> records_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> rawBytes_{0};
+    std::atomic<uint64_t> compressedBytes_{0};
+    std::atomic<uint64_t> errors_{0};
+};
+
+// Binary form of one record (hand types included)
+void encodeHandRecord(std::string& out, const HandRecord& record);
+HandRecord decodeHandRecord(const char* data, size_t size);
+
+// Visit every record in a segment file (memory-mapped). Stops at the first
+// damaged block; returns false if the file can't be read at all. Safe to
+// call from several threads on different files.
+bool readHandHistorySegment(const std::string& path, const std::function<void(const HandRecord&)>& visit);
+
+nlohmann::json handRecordToJson(const HandRecord& record);
+
+} // namespace guts
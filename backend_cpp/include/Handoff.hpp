@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace guts {
+
+// Room code and GameCodec blob
+using RoomImage = std::pair<std::string, std::string>;
+
+// Hot restart over a local Unix socket. The running process listens; a new
+// process started on the same host connects, receives every live room and,
+// once its own listener is up, confirms so the old process can exit. The
+// socket is owner-only and connections from other users are dropped, since
+// the rooms carry player and host tokens.
+//
+//   new -> old   "GHO1"
+//   old -> new   [u64 length][u32 count]([str code][str blob])...
+//   new -> old   'R' (serving)
+class HandoffListener {
+public:
+    // `exportRooms` runs on the listener thread and must stop every room
+    // from changing before it returns. `handedOff` runs once the new
+    // process confirms, or after `confirmSeconds` without an answer.
+    HandoffListener(std::string path, std::function<std::vector<RoomImage>()> exportRooms,
+                    std::function<void()> handedOff, double confirmSeconds = 60.0);
+    ~HandoffListener();
+
+    HandoffListener(const HandoffListener&) = delete;
+    HandoffListener& operator=(const HandoffListener&) = delete;
+
+    // Throws std::runtime_error if the socket can't be bound
+    void start();
+    void stop();
+
+private:
+    void run();
+    void serve(int fd);
+
+    std::string path_;
+    std::function<std::vector<RoomImage>()> exportRooms_;
+    std::function<void()> handedOff_;
+    double confirmSeconds_;
+    int listenFd_ = -1;
+    std::atomic<bool> stopping_{false};
+    std::thread thread_;
+};
+
+// The new process's side of a handoff
+class HandoffClient {
+public:
+    ~HandoffClient();
+
+    // Pull the rooms from a process listening at `path`. False when nobody
+    // is listening (a cold start) or the transfer fails.
+    bool pull(const std::string& path, std::vector<RoomImage>& rooms);
+
+    // Tell the old process we are serving; it then drains and exits
+    void confirm();
+
+private:
+    int fd_ = -1;
+};
+
+} // namespace guts
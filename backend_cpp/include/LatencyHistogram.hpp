@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace guts {
+
+// Log-linear (HDR-style) histogram of nanosecond latencies: values below 32ns
+// get exact buckets, above that every power of two is split into 16
+// sub-buckets (~6% relative error) up to ~9 minutes. Recording is meant for
+// a single writer thread; readers may merge concurrently.
+class LatencyHistogram {
+public:
+    static constexpr size_t kSubBuckets = 16;
+    static constexpr size_t kLinearBuckets = 2 * kSubBuckets;
+    static constexpr unsigned kMaxMagnitude = 39; // 2^39 ns ~ 550s
+    static constexpr size_t kBucketCount = kLinearBuckets + (kMaxMagnitude - 4) * kSubBuckets;
+
+    LatencyHistogram() = default;
+    LatencyHistogram(const LatencyHistogram& other) { mergeFrom(other); }
+    LatencyHistogram& operator=(const LatencyHistogram& other) {
+        if (this != &other) {
+            reset();
+            mergeFrom(other);
+        }
+        return *this;
+    }
+
+    static size_t bucketFor(uint64_t value) {
+        if (value < kLinearBuckets) return static_cast<size_t>(value);
+
+        unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(value));
+        if (msb > kMaxMagnitude) return kBucketCount - 1;
+
+        unsigned shift = msb - 4; // keep the top 5 bits: [16, 32)
+        size_t sub = static_cast<size_t>(value >> shift) - kSubBuckets;
+        return kLinearBuckets + (shift - 1) * kSubBuckets + sub;
+    }
+
+    // Largest value that maps to `bucket`
+    static uint64_t bucketUpperBound(size_t bucket) {
+        if (bucket < kLinearBuckets) return bucket;
+
+        size_t offset = bucket - kLinearBuckets;
+        unsigned shift = static_cast<unsigned>(offset / kSubBuckets) + 1;
+        uint64_t sub = offset % kSubBuckets + kSubBuckets;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    // Single-writer record: plain load/store, no read-modify-write
+    void record(uint64_t value) {
+        bump(buckets_[bucketFor(value)], 1);
+        bump(count_, 1);
+        bump(sum_, value);
+        if (value > max_.load(std::memory_order_relaxed)) {
+            max_.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    // Safe against a concurrent single writer on `other`
+    void mergeFrom(const LatencyHistogram& other) {
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            uint64_t n = other.buckets_[i].load(std::memory_order_relaxed);
+            if (n) buckets_[i].fetch_add(n, std::memory_order_relaxed);
+        }
+        count_.fetch_add(other.count_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        sum_.fetch_add(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        uint64_t otherMax = other.max_.load(std::memory_order_relaxed);
+        if (otherMax > max_.load(std::memory_order_relaxed)) {
+            max_.store(otherMax, std::memory_order_relaxed);
+        }
+    }
+
+    // this -= older, for turning two cumulative snapshots into a window
+    void subtract(const LatencyHistogram& older) {
+        uint64_t total = 0;
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            uint64_t current = buckets_[i].load(std::memory_order_relaxed);
+            uint64_t previous = older.buckets_[i].load(std::memory_order_relaxed);
+            uint64_t n = current > previous ? current - previous : 0;
+            buckets_[i].store(n, std::memory_order_relaxed);
+            total += n;
+        }
+        uint64_t sum = sum_.load(std::memory_order_relaxed);
+        uint64_t olderSum = older.sum_.load(std::memory_order_relaxed);
+        count_.store(total, std::memory_order_relaxed);
+        sum_.store(sum > olderSum ? sum - olderSum : 0, std::memory_order_relaxed);
+    }
+
+    void reset() {
+        for (auto& bucket : buckets_) bucket.store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+    // Upper bound of the bucket holding the q-th quantile (0 if empty)
+    uint64_t valueAtQuantile(double q) const {
+        uint64_t total = count();
+        if (total == 0) return 0;
+
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total));
+        if (rank >= total) rank = total - 1;
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen > rank) {
+                uint64_t bound = bucketUpperBound(i);
+                uint64_t observedMax = max();
+                return observedMax && bound > observedMax ? observedMax : bound;
+            }
+        }
+        return max();
+    }
+
+private:
+    static void bump(std::atomic<uint64_t>& value, uint64_t delta) {
+        value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+} // namespace guts
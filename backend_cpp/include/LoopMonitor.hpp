@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace guts {
+
+// Measures how late scheduled work runs on each event loop. Every loop runs
+// a probe timer that re-arms itself; the difference between when a probe
+// was due and when it actually ran is that loop's lag. Samples go to the
+// guts_loop_lag_seconds histogram, and a smoothed value per loop drives the
+// saturation warning (and, later, load shedding).
+class LoopMonitor {
+public:
+    using ScheduleFn = std::function<void(double delaySeconds, std::function<void()> task)>;
+
+    LoopMonitor(size_t loopCount, double probeIntervalSeconds, double saturationLagMs);
+
+    // Start probing loop `index`; `schedule` must run tasks on that loop
+    void attach(size_t index, ScheduleFn schedule);
+
+    // Smoothed lag of one loop / the worst loop, in milliseconds
+    double lagMs(size_t index) const;
+    double maxLagMs() const;
+
+    bool saturated(size_t index) const;
+    bool anySaturated() const;
+
+    // guts_loop_lag_ewma_seconds and guts_loop_saturated per loop
+    void renderPrometheus(std::string& out) const;
+
+private:
+    struct LoopState {
+        std::atomic<uint64_t> smoothedLagNanos{0};
+        std::atomic<bool> saturated{false};
+        int overThreshold = 0; // consecutive probes above the threshold, loop thread only
+    };
+
+    void probe(size_t index, std::chrono::steady_clock::time_point due);
+    void observe(size_t index, uint64_t lagNanos);
+
+    double probeInterval_;
+    uint64_t saturationLagNanos_;
+    std::vector<std::unique_ptr<LoopState>> loops_;
+    std::vector<ScheduleFn> schedules_;
+};
+
+} // namespace guts
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+namespace guts {
+namespace metrics {
+
+// Monotonic counters
+enum class Counter : size_t {
+    WsConnectionsOpened,
+    WsBytesIn,
+    WsBytesOut,
+    RoundsAllDropped,
+    RoundsMultipleHolders,
+    RoundsDeckWin,
+    RoundsDeckLoss,
+    CleanupEvictions,
+    RoomsHibernated,
+    RoomsWoken,
+    Count
+};
+
+// Up/down values; increments and decrements may come from different threads
+enum class Gauge : size_t {
+    ConnectedSockets,
+    HibernatedRooms,
+    HibernatedBytes,
+    Count
+};
+
+// Every counter lives in a per-thread slot that only its own thread writes,
+// so recording is a relaxed load/store with no locking or contention.
+// Slots are summed when the metrics are scraped.
+void increment(Counter counter, uint64_t amount = 1);
+void adjust(Gauge gauge, int64_t delta);
+
+// Per event type message accounting (unknown events are counted as "other")
+void recordMessageIn(const std::string& event, size_t bytes);
+void recordMessageOut(const std::string& event, size_t bytes, size_t recipients = 1);
+
+// Where a latency sample was taken
+enum class Stage : size_t {
+    Handle, // GameManager::handle* entry points
+    Send,   // serialize + hand off one unicast/broadcast
+    Parse,  // json::parse of an inbound message
+    Count
+};
+
+// Index of a wire event in the metrics event table ("other" if unknown)
+size_t eventId(const std::string& event);
+
+// Latencies go to thread-local histograms; mergeLatencies() folds them into
+// the published p50/p99/p999 window and should be called periodically
+void recordLatency(Stage stage, size_t eventId, uint64_t nanos);
+void mergeLatencies();
+
+// Event loop health, recorded on the loop's own thread. setThreadLoop labels
+// the calling thread's lag samples with its IO loop index.
+void setThreadLoop(size_t loopIndex);
+void recordLoopLag(uint64_t nanos);
+void recordTimerDrift(uint64_t nanos);
+
+class ScopedLatency {
+public:
+    ScopedLatency(Stage stage, const std::string& event)
+        : stage_(stage), eventId_(eventId(event)), start_(std::chrono::steady_clock::now()) {}
+    
+    ~ScopedLatency() {
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        recordLatency(stage_, eventId_,
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+    
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    Stage stage_;
+    size_t eventId_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Append all registered metrics in Prometheus text exposition format
+void renderPrometheus(std::string& out);
+
+// Helpers for metrics computed at scrape time by the caller
+void appendMetricHeader(std::string& out, const char* name, const char* help, const char* type);
+void appendSample(std::string& out, const char* name, const std::string& labels, double value);
+
+} // namespace metrics
+} // namespace guts
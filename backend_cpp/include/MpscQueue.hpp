@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace guts {
+
+// Unbounded multi-producer, single-consumer queue (Vyukov). push() is one
+// atomic exchange plus a store, so producers on event loops never block or
+// spin on each other; pop() must only be called from one consumer thread.
+// T must be default constructible.
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : head_(new Node), tail_(head_.load(std::memory_order_relaxed)) {}
+
+    ~MpscQueue() {
+        T discard;
+        while (pop(discard)) {}
+        delete tail_;
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T value) {
+        Node* node = new Node;
+        node->value = std::move(value);
+        Node* previous = head_.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    // False when empty, or when a producer is between its exchange and its
+    // link store (the item shows up on a later pop)
+    bool pop(T& out) {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next) return false;
+
+        out = std::move(next->value);
+        tail_ = next; // `next` becomes the new dummy node
+        delete tail;
+        return true;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value;
+    };
+
+    std::atomic<Node*> head_; // most recently pushed
+    Node* tail_;              // dummy node before the oldest item, consumer only
+};
+
+} // namespace guts
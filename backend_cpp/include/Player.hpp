@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <chrono>
 #include <nlohmann/json.hpp>
 
 namespace guts {
@@ -15,6 +16,10 @@ struct Player {
     bool isActive;
     std::string socketId;
     
+    // Disconnected mid-round: kept in the round until the grace deadline
+    bool awaitingReconnect = false;
+    std::chrono::steady_clock::time_point reconnectDeadline;
+    
     nlohmann::json toJson() const {
         return {
             {"id", id},
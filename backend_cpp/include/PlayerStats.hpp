@@ -0,0 +1,130 @@
+#pragma once
+
+#include "MpscQueue.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+namespace guts {
+
+// One player's share of a resolved round, or of a finished game
+struct PlayerStatsUpdate {
+    std::string token;           // persistent player token
+    std::string name;
+    double net = 0;              // balance change over the round
+    bool beatDeck = false;       // single holder who beat THE DECK
+    bool finishedGame = false;   // game-end update; `net` is zero
+    bool wonGame = false;
+};
+
+struct LifetimeStats {
+    std::string name;            // latest name seen
+    uint64_t rounds = 0;
+    uint64_t gamesPlayed = 0;
+    uint64_t gamesWon = 0;
+    uint64_t deckWins = 0;
+    double net = 0;
+};
+
+// Highest `capacity` scores of a counter that only grows. A listed player
+// moves up in place; anyone else must beat the last entry, so most updates
+// are one comparison.
+class TopK {
+public:
+    explicit TopK(size_t capacity) : capacity_(capacity) {}
+
+    void update(const std::string* key, double score);
+
+    const std::vector<std::pair<double, const std::string*>>& entries() const { return entries_; }
+
+private:
+    size_t capacity_;
+    std::vector<std::pair<double, const std::string*>> entries_; // best first
+};
+
+// Lifetime statistics by player token across all shards. Managers push
+// updates from their loops onto a lock-free queue; one aggregator thread
+// applies each in O(1) (net profit, which can fall, keeps an ordered index
+// at O(log n)) and republishes the leaderboard JSON at most once per
+// `publishSeconds`. Readers only copy a shared_ptr to the cached body.
+class PlayerStats {
+public:
+    struct Options {
+        std::string path;              // optional; loaded on start, saved periodically
+        size_t leaderboardSize = 10;
+        double publishSeconds = 1.0;
+        double saveSeconds = 60.0;
+        size_t maxQueued = 100000;     // beyond this, updates are dropped
+    };
+
+    explicit PlayerStats(Options options);
+    ~PlayerStats();
+
+    PlayerStats(const PlayerStats&) = delete;
+    PlayerStats& operator=(const PlayerStats&) = delete;
+
+    void start();
+
+    // Apply everything queued, save, and stop the aggregator
+    void stop();
+
+    // Any thread; never blocks
+    void record(PlayerStatsUpdate update);
+
+    // Cached leaderboard JSON: {"updatedAt","players","gamesWon","netProfit","deckWins"}
+    std::shared_ptr<const std::string> leaderboard() const;
+
+    size_t queueDepth() const { return queued_.load(std::memory_order_relaxed); }
+
+    void renderPrometheus(std::string& out) const;
+
+private:
+    struct ByNet {
+        bool operator()(const std::pair<double, const std::string*>& a,
+                        const std::pair<double, const std::string*>& b) const {
+            return a.first != b.first ? a.first > b.first : *a.second < *b.second;
+        }
+    };
+
+    void run();
+    bool drain();
+    void apply(const PlayerStatsUpdate& update);
+    void publish();
+    void load();
+    void save();
+
+    Options options_;
+    MpscQueue<PlayerStatsUpdate> queue_;
+    std::atomic<size_t> queued_{0};
+    std::atomic<bool> stopping_{false};
+    std::thread aggregator_;
+
+    // Aggregator thread only (and start(), before it runs). Index entries
+    // point at the map's keys, which stay put while the map grows.
+    std::unordered_map<std::string, LifetimeStats> players_;
+    TopK gamesWon_;
+    TopK deckWins_;
+    std::set<std::pair<double, const std::string*>, ByNet> byNet_;
+    bool changed_ = false;
+    bool unsaved_ = false;
+    std::chrono::steady_clock::time_point lastPublish_;
+    std::chrono::steady_clock::time_point lastSave_;
+
+    mutable std::mutex leaderboardMutex_;
+    std::shared_ptr<const std::string> leaderboard_;
+
+    std::atomic<size_t> playerCount_{0};
+    std::atomic<uint64_t> updates_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> errors_{0};
+};
+
+} // namespace guts
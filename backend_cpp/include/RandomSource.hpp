@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <random>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace guts {
+
+// Where a room's randomness comes from: deck shuffles and player IDs.
+// Production uses SecureRandom; tools, benchmarks and replays can use a
+// SeededRandom so the same script produces byte-identical output.
+class RandomSource {
+public:
+    virtual ~RandomSource() = default;
+
+    virtual uint64_t next() = 0;
+
+    // Uniform in [0, bound) without modulo bias
+    uint64_t uniform(uint64_t bound);
+};
+
+// OpenSSL RAND_bytes, fetched in blocks to amortize the call
+class SecureRandom : public RandomSource {
+public:
+    uint64_t next() override;
+
+private:
+    std::array<uint64_t, 32> buffer_{};
+    size_t used_ = buffer_.size();
+};
+
+class SeededRandom : public RandomSource {
+public:
+    explicit SeededRandom(uint64_t seed) : engine_(seed) {}
+
+    uint64_t next() override { return engine_(); }
+
+private:
+    std::mt19937_64 engine_;
+};
+
+// Stable per-room seed from a base seed and the room code
+uint64_t deriveSeed(uint64_t seed, const std::string& key);
+
+// UUID-formatted random identifier drawn from `source`
+std::string generateUUID(RandomSource& source);
+
+} // namespace guts
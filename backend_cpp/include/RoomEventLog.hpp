@@ -0,0 +1,92 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+namespace guts {
+
+struct RoomEvent {
+    uint64_t seq;
+    std::string event;
+    nlohmann::json data;
+    std::string targetPlayerId; // empty = whole room
+};
+
+// Bounded ring buffer of the most recent outbound events of a room.
+// Every logged event gets the next per-room sequence number so a
+// reconnecting client can ask for exactly the events it missed.
+class RoomEventLog {
+public:
+    static constexpr size_t kDefaultCapacity = 256;
+
+    explicit RoomEventLog(size_t capacity = kDefaultCapacity)
+        : capacity_(capacity == 0 ? 1 : capacity), head_(0), lastSeq_(0) {
+        // No reserve: the buffer grows with use and only wraps once full,
+        // so a quiet lobby doesn't pay for the whole ring
+    }
+
+    uint64_t lastSeq() const { return lastSeq_; }
+    uint64_t nextSeq() const { return lastSeq_ + 1; }
+
+    // Oldest sequence number still held in the buffer
+    uint64_t firstSeq() const { return lastSeq_ + 1 - events_.size(); }
+
+    // Buffered events in storage order, for memory accounting
+    const std::vector<RoomEvent>& buffered() const { return events_; }
+
+    // Drop the buffered events and continue numbering after `lastSeq`, e.g.
+    // for a room restored from disk. Clients behind it resync from a snapshot.
+    void resetTo(uint64_t lastSeq) {
+        events_.clear();
+        head_ = 0;
+        lastSeq_ = lastSeq;
+    }
+
+    uint64_t append(const std::string& event, const nlohmann::json& data,
+                    const std::string& targetPlayerId = "") {
+        RoomEvent entry{++lastSeq_, event, data, targetPlayerId};
+
+        if (events_.size() < capacity_) {
+            events_.push_back(std::move(entry));
+        } else {
+            events_[head_] = std::move(entry);
+            head_ = (head_ + 1) % capacity_;
+        }
+
+        return lastSeq_;
+    }
+
+    // Collect the events after `afterSeq` that are visible to `playerId`.
+    // Returns false if the buffer no longer covers the gap (or the sequence
+    // is from another incarnation of the room) and a snapshot is needed.
+    bool eventsSince(uint64_t afterSeq, const std::string& playerId,
+                     std::vector<const RoomEvent*>& out) const {
+        if (afterSeq > lastSeq_ || afterSeq + 1 < firstSeq()) {
+            return false;
+        }
+
+        for (uint64_t seq = afterSeq + 1; seq <= lastSeq_; ++seq) {
+            const RoomEvent& entry = at(seq);
+            if (entry.targetPlayerId.empty() || entry.targetPlayerId == playerId) {
+                out.push_back(&entry);
+            }
+        }
+
+        return true;
+    }
+
+private:
+    const RoomEvent& at(uint64_t seq) const {
+        size_t offset = static_cast<size_t>(seq - firstSeq());
+        return events_[(head_ + offset) % events_.size()];
+    }
+
+    size_t capacity_;
+    size_t head_;
+    uint64_t lastSeq_;
+    std::vector<RoomEvent> events_;
+};
+
+} // namespace guts
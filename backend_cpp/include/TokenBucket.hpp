@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <cmath>
+#include <algorithm>
+
+namespace guts {
+
+// Thread-safe token bucket used to pace admissions (e.g. joins during a
+// reconnect storm). Tokens refill continuously at `ratePerSecond` up to
+// `burst`.
+class TokenBucket {
+public:
+    TokenBucket(double ratePerSecond, double burst)
+        : rate_(ratePerSecond), burst_(std::max(1.0, burst)), tokens_(burst_),
+          lastRefill_(std::chrono::steady_clock::now()) {}
+    
+    // Takes one token. Returns zero when admitted, otherwise how long the
+    // caller should wait before a token will be available.
+    std::chrono::milliseconds tryAcquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refill();
+        
+        if (tokens_ >= 1.0) {
+            tokens_ -= 1.0;
+            return std::chrono::milliseconds(0);
+        }
+        
+        if (rate_ <= 0) return std::chrono::milliseconds(1000);
+        double waitMs = std::ceil((1.0 - tokens_) / rate_ * 1000.0);
+        return std::chrono::milliseconds(static_cast<long long>(std::max(1.0, waitMs)));
+    }
+    
+    double available() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refill();
+        return tokens_;
+    }
+
+private:
+    void refill() {
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = now - lastRefill_;
+        lastRefill_ = now;
+        tokens_ = std::min(burst_, tokens_ + elapsed.count() * rate_);
+    }
+    
+    std::mutex mutex_;
+    double rate_;
+    double burst_;
+    double tokens_;
+    std::chrono::steady_clock::time_point lastRefill_;
+};
+
+} // namespace guts
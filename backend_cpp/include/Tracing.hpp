@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace guts {
+namespace tracing {
+
+using Clock = std::chrono::steady_clock;
+
+// Spans are kept in one bounded ring buffer (oldest overwritten first) and
+// exported in Chrome trace-event format, one process row per room. A
+// capacity of 0 disables tracing; recording is then a single branch.
+void setCapacity(size_t capacity);
+bool enabled();
+
+// A finished span [start, end] for one round of a room. `designedMs` is the
+// intended duration for delays (animation waits), or negative if none.
+void complete(const char* name, const std::string& roomCode, int round,
+              Clock::time_point start, Clock::time_point end, double designedMs = -1.0);
+
+// Zero-length marker
+void instant(const char* name, const std::string& roomCode, int round);
+
+// Chrome trace JSON ({"traceEvents": [...]}), optionally for one room only
+void renderChromeTrace(std::string& out, const std::string& roomFilter = "");
+
+// Times a synchronous section, e.g. a handler or a resolution step
+class Span {
+public:
+    Span(const char* name, const std::string& roomCode, int round)
+        : name_(name), roomCode_(roomCode), round_(round), start_(Clock::now()) {}
+
+    ~Span() {
+        if (enabled()) complete(name_, roomCode_, round_, start_, Clock::now());
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* name_;
+    std::string roomCode_;
+    int round_;
+    Clock::time_point start_;
+};
+
+} // namespace tracing
+} // namespace guts
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <functional>
+#include <limits>
+#include <queue>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace guts {
+
+// Deterministic stand-in for an event loop's timers, for driving a
+// GameManager from tools without real sleeps. Tasks run in due-time order
+// (FIFO among equal times) on the calling thread as virtual time advances.
+class VirtualScheduler {
+public:
+    void schedule(double delaySeconds, std::function<void()> task) {
+        queue_.push({now_ + (delaySeconds > 0 ? delaySeconds : 0.0), nextOrder_++, std::move(task)});
+    }
+
+    // Suitable for the GameManager constructor
+    std::function<void(double, std::function<void()>)> callback() {
+        return [this](double delaySeconds, std::function<void()> task) {
+            schedule(delaySeconds, std::move(task));
+        };
+    }
+
+    double now() const { return now_; }
+    size_t pending() const { return queue_.size(); }
+    
+    // Due time of the earliest task, infinity when idle
+    double nextDue() const {
+        return queue_.empty() ? std::numeric_limits<double>::infinity() : queue_.top().due;
+    }
+
+    // Run the earliest task, jumping virtual time to it. False if idle.
+    bool runNext() {
+        if (queue_.empty()) return false;
+
+        Entry entry = queue_.top();
+        queue_.pop();
+        if (entry.due > now_) now_ = entry.due;
+        entry.task();
+        return true;
+    }
+
+    // Run everything due within the next `seconds` of virtual time
+    size_t advance(double seconds) {
+        double until = now_ + seconds;
+        size_t ran = 0;
+        while (!queue_.empty() && queue_.top().due <= until) {
+            runNext();
+            ++ran;
+        }
+        now_ = until;
+        return ran;
+    }
+
+    // Drain the queue, including tasks scheduled by tasks
+    size_t runUntilIdle(size_t maxTasks = SIZE_MAX) {
+        size_t ran = 0;
+        while (ran < maxTasks && runNext()) ++ran;
+        return ran;
+    }
+
+private:
+    struct Entry {
+        double due;
+        uint64_t order;
+        std::function<void()> task;
+    };
+
+    struct Later {
+        bool operator()(const Entry& a, const Entry& b) const {
+            return a.due != b.due ? a.due > b.due : a.order > b.order;
+        }
+    };
+
+    std::priority_queue<Entry, std::vector<Entry>, Later> queue_;
+    double now_ = 0.0;
+    uint64_t nextOrder_ = 0;
+};
+
+} // namespace guts
@@ -0,0 +1,99 @@
+#include "AdmissionControl.hpp"
+#include "Metrics.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+namespace guts {
+
+namespace {
+
+// Signals must fall below this fraction of their limits before the level
+// drops, so shedding doesn't flap around a threshold
+constexpr double kRecoveryScale = 0.8;
+
+} // namespace
+
+const char* admissionLevelName(AdmissionController::Level level) {
+    switch (level) {
+        case AdmissionController::Level::Normal: return "normal";
+        case AdmissionController::Level::ShedCreates: return "shed_creates";
+        case AdmissionController::Level::ShedJoins: return "shed_joins";
+    }
+    return "unknown";
+}
+
+AdmissionController::AdmissionController(Limits limits) : limits_(limits) {
+}
+
+AdmissionController::Level AdmissionController::pressure(const Signals& signals, double scale) const {
+    auto over = [scale](double value, double limit, double factor) {
+        return limit > 0 && value >= limit * factor * scale;
+    };
+    const double join = limits_.joinFactor;
+
+    if (over(signals.lagMs, limits_.lagMs, join) ||
+        over(static_cast<double>(signals.rssBytes), static_cast<double>(limits_.rssBytes), join) ||
+        over(static_cast<double>(signals.queueDepth), static_cast<double>(limits_.queueDepth), join)) {
+        return Level::ShedJoins;
+    }
+    if (over(signals.lagMs, limits_.lagMs, 1.0) ||
+        over(static_cast<double>(signals.rooms), static_cast<double>(limits_.rooms), 1.0) ||
+        over(static_cast<double>(signals.rssBytes), static_cast<double>(limits_.rssBytes), 1.0) ||
+        over(static_cast<double>(signals.queueDepth), static_cast<double>(limits_.queueDepth), 1.0)) {
+        return Level::ShedCreates;
+    }
+    return Level::Normal;
+}
+
+void AdmissionController::update(const Signals& signals) {
+    rooms_.store(signals.rooms, std::memory_order_relaxed);
+    rssBytes_.store(signals.rssBytes, std::memory_order_relaxed);
+    queueDepth_.store(signals.queueDepth, std::memory_order_relaxed);
+
+    Level current = level();
+    Level next = pressure(signals, 1.0);
+    if (next < current) next = std::min(current, pressure(signals, kRecoveryScale));
+    if (next == current) return;
+
+    level_.store(static_cast<int>(next), std::memory_order_relaxed);
+    std::cerr << "Admission: " << admissionLevelName(current) << " -> " << admissionLevelName(next)
+              << " (lag " << signals.lagMs << "ms, " << signals.rooms << " rooms, "
+              << signals.rssBytes / (1024 * 1024) << "MB resident, queue " << signals.queueDepth << ")" << std::endl;
+}
+
+bool AdmissionController::admitCreate() {
+    if (level() == Level::Normal) return true;
+    shedCreates_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool AdmissionController::admitJoin() {
+    if (level() != Level::ShedJoins) return true;
+    shedJoins_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+uint64_t AdmissionController::residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    uint64_t sizePages = 0, residentPages = 0;
+    if (!(statm >> sizePages >> residentPages)) return 0;
+    return residentPages * static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+}
+
+void AdmissionController::renderPrometheus(std::string& out) const {
+    metrics::appendMetricHeader(out, "guts_admission_level", "0 normal, 1 shedding creates, 2 shedding new joins too", "gauge");
+    metrics::appendSample(out, "guts_admission_level", "", static_cast<double>(level_.load(std::memory_order_relaxed)));
+    metrics::appendMetricHeader(out, "guts_admission_shed_total", "Requests turned away with 503 by admission control", "counter");
+    metrics::appendSample(out, "guts_admission_shed_total", "kind=\"create\"", static_cast<double>(shedCreates_.load(std::memory_order_relaxed)));
+    metrics::appendSample(out, "guts_admission_shed_total", "kind=\"join\"", static_cast<double>(shedJoins_.load(std::memory_order_relaxed)));
+    metrics::appendMetricHeader(out, "guts_admission_rooms", "Live and hibernated rooms at the last admission check", "gauge");
+    metrics::appendSample(out, "guts_admission_rooms", "", static_cast<double>(rooms_.load(std::memory_order_relaxed)));
+    metrics::appendMetricHeader(out, "guts_admission_queue_depth", "Background writer backlog at the last admission check", "gauge");
+    metrics::appendSample(out, "guts_admission_queue_depth", "", static_cast<double>(queueDepth_.load(std::memory_order_relaxed)));
+    metrics::appendMetricHeader(out, "guts_process_resident_bytes", "Resident set size at the last admission check", "gauge");
+    metrics::appendSample(out, "guts_process_resident_bytes", "", static_cast<double>(rssBytes_.load(std::memory_order_relaxed)));
+}
+
+} // namespace guts
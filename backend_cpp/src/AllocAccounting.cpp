@@ -0,0 +1,233 @@
+#include "AllocAccounting.hpp"
+#include "Metrics.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+namespace guts {
+namespace alloc {
+
+namespace {
+
+constexpr size_t kMaxTags = 64;
+constexpr size_t kMaxThreads = 512;
+constexpr size_t kUntagged = 0;
+
+struct Counters {
+    std::atomic<uint64_t> scopes;
+    std::atomic<uint64_t> allocations;
+    std::atomic<uint64_t> frees;
+    std::atomic<uint64_t> bytes;
+};
+
+struct ThreadAllocSlot {
+    std::array<Counters, kMaxTags> tags;
+};
+
+// Everything here is static storage with constant initialization: the hooks
+// can run before main() and must never allocate themselves
+ThreadAllocSlot slots[kMaxThreads];
+std::atomic<size_t> slotsUsed{0};
+Counters overflow[kMaxTags]; // shared by threads beyond kMaxThreads
+
+const char* tagNames[kMaxTags] = {"untagged"};
+std::atomic<size_t> tagCount{1};
+std::mutex tagMutex;
+
+thread_local ThreadAllocSlot* localSlot = nullptr;
+thread_local bool slotClaimed = false;
+thread_local size_t currentTag = kUntagged;
+
+Counters& countersFor(size_t tag) {
+    if (!slotClaimed) {
+        slotClaimed = true;
+        size_t index = slotsUsed.fetch_add(1, std::memory_order_relaxed);
+        localSlot = index < kMaxThreads ? &slots[index] : nullptr;
+    }
+    return localSlot ? localSlot->tags[tag] : overflow[tag];
+}
+
+// Owned slots have a single writer; the overflow slot needs a real RMW
+void add(std::atomic<uint64_t>& value, uint64_t delta) {
+    if (localSlot) {
+        value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    } else {
+        value.fetch_add(delta, std::memory_order_relaxed);
+    }
+}
+
+void noteAllocation(size_t size) {
+    Counters& counters = countersFor(currentTag);
+    add(counters.allocations, 1);
+    add(counters.bytes, size);
+}
+
+void noteFree() {
+    add(countersFor(currentTag).frees, 1);
+}
+
+size_t tagIndex(const char* tag) {
+    size_t count = tagCount.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        if (tagNames[i] == tag || std::strcmp(tagNames[i], tag) == 0) return i;
+    }
+
+    std::lock_guard<std::mutex> lock(tagMutex);
+    count = tagCount.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) {
+        if (std::strcmp(tagNames[i], tag) == 0) return i;
+    }
+    if (count == kMaxTags) return kUntagged;
+
+    tagNames[count] = tag;
+    tagCount.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+AllocStats read(const Counters& counters) {
+    AllocStats stats;
+    stats.scopes = counters.scopes.load(std::memory_order_relaxed);
+    stats.allocations = counters.allocations.load(std::memory_order_relaxed);
+    stats.frees = counters.frees.load(std::memory_order_relaxed);
+    stats.bytes = counters.bytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void accumulate(AllocStats& total, const AllocStats& stats) {
+    total.scopes += stats.scopes;
+    total.allocations += stats.allocations;
+    total.frees += stats.frees;
+    total.bytes += stats.bytes;
+}
+
+} // namespace
+
+AllocScope::AllocScope(const char* tag) : previous_(currentTag) {
+    currentTag = tagIndex(tag);
+    add(countersFor(currentTag).scopes, 1);
+}
+
+AllocScope::~AllocScope() {
+    currentTag = previous_;
+}
+
+AllocStats threadTotals() {
+    AllocStats total;
+    countersFor(kUntagged);
+    size_t count = tagCount.load(std::memory_order_acquire);
+    for (size_t tag = 0; tag < count; ++tag) {
+        accumulate(total, read(localSlot ? localSlot->tags[tag] : overflow[tag]));
+    }
+    return total;
+}
+
+std::vector<TaggedStats> totalsByTag() {
+    size_t count = tagCount.load(std::memory_order_acquire);
+    size_t threads = std::min(slotsUsed.load(std::memory_order_relaxed), kMaxThreads);
+
+    std::vector<TaggedStats> totals;
+    totals.reserve(count);
+    for (size_t tag = 0; tag < count; ++tag) {
+        AllocStats stats = read(overflow[tag]);
+        for (size_t i = 0; i < threads; ++i) {
+            accumulate(stats, read(slots[i].tags[tag]));
+        }
+        totals.push_back({tagNames[tag], stats});
+    }
+    return totals;
+}
+
+void renderPrometheus(std::string& out) {
+    auto totals = totalsByTag();
+
+    metrics::appendMetricHeader(out, "guts_alloc_total", "Heap allocations by handler tag", "counter");
+    for (const auto& entry : totals) {
+        metrics::appendSample(out, "guts_alloc_total", std::string("tag=\"") + entry.tag + "\"",
+            static_cast<double>(entry.stats.allocations));
+    }
+
+    metrics::appendMetricHeader(out, "guts_alloc_bytes_total", "Heap bytes requested by handler tag", "counter");
+    for (const auto& entry : totals) {
+        metrics::appendSample(out, "guts_alloc_bytes_total", std::string("tag=\"") + entry.tag + "\"",
+            static_cast<double>(entry.stats.bytes));
+    }
+
+    metrics::appendMetricHeader(out, "guts_free_total", "Heap frees by handler tag", "counter");
+    for (const auto& entry : totals) {
+        metrics::appendSample(out, "guts_free_total", std::string("tag=\"") + entry.tag + "\"",
+            static_cast<double>(entry.stats.frees));
+    }
+}
+
+} // namespace alloc
+} // namespace guts
+
+// Global replacements. Aligned variants round the size up to the alignment
+// as aligned_alloc requires.
+namespace {
+
+void* countedAlloc(std::size_t size) {
+    guts::alloc::noteAllocation(size);
+    if (size == 0) size = 1;
+    for (;;) {
+        if (void* p = std::malloc(size)) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* countedAlignedAlloc(std::size_t size, std::align_val_t align) {
+    guts::alloc::noteAllocation(size);
+    std::size_t alignment = std::max(static_cast<std::size_t>(align), sizeof(void*));
+    std::size_t rounded = size == 0 ? alignment : (size + alignment - 1) / alignment * alignment;
+    for (;;) {
+        if (void* p = std::aligned_alloc(alignment, rounded)) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void countedFree(void* p) noexcept {
+    if (!p) return;
+    guts::alloc::noteFree();
+    std::free(p);
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+void* operator new(std::size_t size, std::align_val_t align) { return countedAlignedAlloc(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return countedAlignedAlloc(size, align); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAlloc(size); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAlloc(size); } catch (...) { return nullptr; }
+}
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    try { return countedAlignedAlloc(size, align); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    try { return countedAlignedAlloc(size, align); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, std::size_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { countedFree(p); }
+void operator delete(void* p, std::align_val_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { countedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { countedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { countedFree(p); }
@@ -0,0 +1,134 @@
+#include "Capture.hpp"
+#include "GameCodec.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace guts {
+
+namespace {
+
+constexpr char kCaptureMagic[5] = {'G', 'C', 'A', 'P', '1'};
+
+} // namespace
+
+CaptureRecorder::CaptureRecorder(const std::string& path, uint64_t maxBytes)
+    : file_(std::fopen(path.c_str(), "wb")), maxBytes_(maxBytes),
+      started_(std::chrono::steady_clock::now()) {
+    if (!file_) {
+        throw std::runtime_error("Cannot open capture file " + path + ": " + std::strerror(errno));
+    }
+
+    std::string header(kCaptureMagic, sizeof(kCaptureMagic));
+    BinaryWriter writer(header);
+    writer.u64(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count()));
+    std::fwrite(header.data(), 1, header.size(), file_);
+    bytes_ = header.size();
+
+    writer_ = std::thread([this]() { run(); });
+}
+
+CaptureRecorder::~CaptureRecorder() {
+    stop();
+}
+
+void CaptureRecorder::record(const std::string& socketId, const std::string& event, const std::string& message) {
+    if (full_.load(std::memory_order_relaxed)) return;
+
+    CaptureEvent entry;
+    entry.offsetMicros = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - started_).count());
+    entry.socketId = socketId;
+    entry.event = event;
+    entry.message = message;
+    queue_.push(std::move(entry));
+}
+
+void CaptureRecorder::stop() {
+    if (stopping_.exchange(true)) return;
+    if (writer_.joinable()) writer_.join();
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+void CaptureRecorder::run() {
+    while (!stopping_.load(std::memory_order_acquire)) {
+        if (!drain()) {
+            std::fflush(file_);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    drain();
+    std::fflush(file_);
+}
+
+bool CaptureRecorder::drain() {
+    CaptureEvent entry;
+    std::string buffer;
+    bool any = false;
+    while (queue_.pop(entry)) {
+        any = true;
+        if (full_.load(std::memory_order_relaxed)) continue;
+
+        buffer.clear();
+        BinaryWriter writer(buffer);
+        writer.u32(0);
+        writer.u64(entry.offsetMicros);
+        writer.str(entry.socketId);
+        writer.str(entry.event);
+        writer.str(entry.message);
+        uint32_t length = static_cast<uint32_t>(buffer.size() - 4);
+        for (int i = 0; i < 4; ++i) buffer[i] = static_cast<char>(length >> (8 * i));
+
+        if (bytes_ + buffer.size() > maxBytes_) {
+            full_.store(true, std::memory_order_relaxed);
+            std::cerr << "Capture: size limit reached after " << recorded() << " events, recording stopped" << std::endl;
+            continue;
+        }
+        std::fwrite(buffer.data(), 1, buffer.size(), file_);
+        bytes_ += buffer.size();
+        recorded_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return any;
+}
+
+bool readCapture(const std::string& path, uint64_t& startUnixMs,
+                 const std::function<void(const CaptureEvent&)>& visit) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    const std::string data = contents.str();
+    if (data.size() < sizeof(kCaptureMagic) + 8 ||
+        std::memcmp(data.data(), kCaptureMagic, sizeof(kCaptureMagic)) != 0) {
+        return false;
+    }
+
+    BinaryReader reader(data.data() + sizeof(kCaptureMagic), data.size() - sizeof(kCaptureMagic));
+    startUnixMs = reader.u64();
+
+    CaptureEvent entry;
+    try {
+        while (reader.remaining() >= 4) {
+            uint32_t length = reader.u32();
+            if (length > reader.remaining()) break; // cut short by a crash
+            entry.offsetMicros = reader.u64();
+            entry.socketId = reader.str();
+            entry.event = reader.str();
+            entry.message = reader.str();
+            visit(entry);
+        }
+    } catch (const std::exception&) {
+        // Truncated tail; everything before it was delivered
+    }
+    return true;
+}
+
+} // namespace guts
@@ -0,0 +1,148 @@
+#include "Cluster.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+
+namespace guts {
+
+namespace {
+
+// Same alphabet as GameManager::generateRoomCode
+constexpr char kCodeAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+constexpr uint64_t kCodeAlphabetSize = sizeof(kCodeAlphabet) - 1;
+
+// FNV-1a finished with a splitmix64 mix; stable across builds, unlike std::hash
+uint64_t stableHash(const std::string& key) {
+    uint64_t hash = 1469598103934665603ull;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    hash += 0x9e3779b97f4a7c15ull;
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+    return hash ^ (hash >> 31);
+}
+
+std::chrono::system_clock::time_point modifiedAt(const std::string& path) {
+    struct stat info {};
+    if (::stat(path.c_str(), &info) != 0) return {};
+    return std::chrono::system_clock::time_point(
+        std::chrono::seconds(info.st_mtim.tv_sec) +
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(info.st_mtim.tv_nsec)));
+}
+
+} // namespace
+
+std::string nodeTag(const std::string& nodeId) {
+    uint64_t hash = stableHash(nodeId);
+    std::string tag;
+    for (size_t i = 0; i < kNodeTagLength; ++i) {
+        tag += kCodeAlphabet[hash % kCodeAlphabetSize];
+        hash /= kCodeAlphabetSize;
+    }
+    return tag;
+}
+
+std::vector<ClusterNode> loadClusterFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("Cannot read cluster file " + path);
+
+    std::vector<ClusterNode> nodes;
+    std::string line;
+    for (int number = 1; std::getline(file, line); ++number) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        ClusterNode node;
+        if (!(fields >> node.id)) continue;
+
+        std::string extra;
+        if (!(fields >> node.url) || (fields >> extra)) {
+            throw std::runtime_error(path + ":" + std::to_string(number) + ": expected \"nodeId url\"");
+        }
+        node.tag = nodeTag(node.id);
+        for (const auto& existing : nodes) {
+            if (existing.id == node.id) {
+                throw std::runtime_error(path + ":" + std::to_string(number) + ": duplicate node " + node.id);
+            }
+            // Rooms are found by tag, so it has to pick out one node
+            if (existing.tag == node.tag) {
+                throw std::runtime_error(path + ":" + std::to_string(number) + ": nodes " + existing.id + " and " +
+                                         node.id + " share room code prefix " + node.tag + "; rename one");
+            }
+        }
+        while (!node.url.empty() && node.url.back() == '/') node.url.pop_back();
+        nodes.push_back(std::move(node));
+    }
+    return nodes;
+}
+
+std::string webSocketUrl(const std::string& url) {
+    if (url.compare(0, 8, "https://") == 0) return "wss://" + url.substr(8) + "/ws";
+    if (url.compare(0, 7, "http://") == 0) return "ws://" + url.substr(7) + "/ws";
+    return url + "/ws";
+}
+
+ClusterMembership::ClusterMembership(std::string path, std::string selfId)
+    : path_(std::move(path)), selfId_(std::move(selfId)), selfTag_(nodeTag(selfId_)) {
+    loadedMtime_ = modifiedAt(path_);
+    install(loadClusterFile(path_));
+}
+
+bool ClusterMembership::reload() {
+    auto mtime = modifiedAt(path_);
+    if (mtime == loadedMtime_) return false;
+    loadedMtime_ = mtime;
+
+    try {
+        install(loadClusterFile(path_));
+    } catch (const std::exception& e) {
+        std::cerr << "Cluster: keeping the current members: " << e.what() << std::endl;
+        return false;
+    }
+    std::cout << "Cluster: now " << nodeCount() << " nodes" << std::endl;
+    return true;
+}
+
+void ClusterMembership::install(std::vector<ClusterNode> nodes) {
+    bool present = std::any_of(nodes.begin(), nodes.end(),
+                               [this](const ClusterNode& node) { return node.id == selfId_; });
+    if (!present) {
+        throw std::runtime_error("Node " + selfId_ + " is not listed in " + path_);
+    }
+    auto members = std::make_shared<const std::vector<ClusterNode>>(std::move(nodes));
+    std::lock_guard<std::mutex> lock(mutex_);
+    nodes_ = std::move(members);
+}
+
+std::shared_ptr<const std::vector<ClusterNode>> ClusterMembership::nodes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nodes_;
+}
+
+std::string ClusterMembership::remoteOwner(const std::string& roomCode) const {
+    if (roomCode.compare(0, kNodeTagLength, selfTag_) == 0) return std::string();
+    auto current = nodes();
+    for (const auto& node : *current) {
+        if (roomCode.compare(0, kNodeTagLength, node.tag) == 0) return node.url;
+    }
+    return std::string();
+}
+
+std::string ClusterMembership::selfWebSocketUrl() const {
+    auto current = nodes();
+    for (const auto& node : *current) {
+        if (node.id == selfId_) return webSocketUrl(node.url);
+    }
+    return std::string();
+}
+
+size_t ClusterMembership::nodeCount() const {
+    return nodes()->size();
+}
+
+} // namespace guts
@@ -0,0 +1,148 @@
+#include "GameCodec.hpp"
+
+namespace guts {
+
+namespace {
+
+constexpr uint8_t kCodecVersion = 1;
+
+const char* const RANK_NAMES[] = {
+    "2", "3", "4", "5", "6", "7", "8", "9", "10", "J", "Q", "K", "A"
+};
+
+// A card is its value (2-14) and suit in one byte each
+void writeCard(BinaryWriter& out, const Card& card) {
+    out.u8(static_cast<uint8_t>(card.value));
+    out.u8(static_cast<uint8_t>(card.suit));
+}
+
+Card readCard(BinaryReader& in) {
+    int value = in.u8();
+    uint8_t suit = in.u8();
+    if (value < 2 || value > 14 || suit > 3) throw std::runtime_error("Invalid card");
+    return {RANK_NAMES[value - 2], static_cast<Suit>(suit), value};
+}
+
+} // namespace
+
+void writeCards(BinaryWriter& out, const std::vector<Card>& cards) {
+    out.u32(static_cast<uint32_t>(cards.size()));
+    for (const auto& card : cards) writeCard(out, card);
+}
+
+std::vector<Card> readCards(BinaryReader& in) {
+    uint32_t count = in.u32();
+    if (count > 52) throw std::runtime_error("Invalid card count");
+    std::vector<Card> cards;
+    cards.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) cards.push_back(readCard(in));
+    return cards;
+}
+
+std::string encodeGame(const Game& game) {
+    std::string blob;
+    blob.reserve(256 + game.players.size() * 96 + game.deck.size() * 2);
+    BinaryWriter out(blob);
+
+    out.u8(kCodecVersion);
+    out.str(game.roomCode);
+    out.str(game.hostToken);
+    out.u8(static_cast<uint8_t>(game.state));
+    out.f64(game.buyInAmount);
+    out.f64(game.ante);
+    out.f64(game.pot);
+    out.i64(game.round);
+    out.u8(game.isNothingRound);
+    out.u8(game.pendingGameEnd);
+    out.u8(game.roundResolved);
+    out.u8(game.roundInFlight);
+    out.i64(std::chrono::duration_cast<std::chrono::milliseconds>(
+        game.lastActivity.time_since_epoch()).count());
+    out.u64(game.eventLog.lastSeq());
+
+    out.u32(static_cast<uint32_t>(game.players.size()));
+    for (const auto& player : game.players) {
+        out.str(player.id);
+        out.str(player.token);
+        out.str(player.name);
+        out.f64(player.balance);
+        out.f64(player.buyInAmount);
+        out.u8(player.isHost);
+        out.u8(player.isActive);
+    }
+
+    writeCards(out, game.deck);
+
+    out.u32(static_cast<uint32_t>(game.currentHands.size()));
+    for (const auto& [playerId, cards] : game.currentHands) {
+        out.str(playerId);
+        writeCards(out, cards);
+    }
+
+    out.u32(static_cast<uint32_t>(game.decisions.size()));
+    for (const auto& [playerId, decision] : game.decisions) {
+        out.str(playerId);
+        out.u8(decision == "hold");
+    }
+
+    return blob;
+}
+
+std::unique_ptr<Game> decodeGame(const std::string& blob) {
+    BinaryReader in(blob.data(), blob.size());
+
+    if (in.u8() != kCodecVersion) throw std::runtime_error("Unsupported game codec version");
+
+    std::string roomCode = in.str();
+    std::string hostToken = in.str();
+    auto game = std::make_unique<Game>(roomCode, hostToken);
+
+    uint8_t state = in.u8();
+    if (state > static_cast<uint8_t>(GameState::ENDED)) throw std::runtime_error("Invalid game state");
+    game->state = static_cast<GameState>(state);
+    game->buyInAmount = in.f64();
+    game->ante = in.f64();
+    game->pot = in.f64();
+    game->round = static_cast<int>(in.i64());
+    game->isNothingRound = in.u8() != 0;
+    game->pendingGameEnd = in.u8() != 0;
+    game->roundResolved = in.u8() != 0;
+    game->roundInFlight = in.u8() != 0;
+    game->lastActivity = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::milliseconds(in.i64())));
+    game->eventLog.resetTo(in.u64());
+
+    uint32_t playerCount = in.u32();
+    if (playerCount > 64) throw std::runtime_error("Invalid player count");
+    game->players.reserve(playerCount);
+    for (uint32_t i = 0; i < playerCount; ++i) {
+        Player player;
+        player.id = in.str();
+        player.token = in.str();
+        player.name = in.str();
+        player.balance = in.f64();
+        player.buyInAmount = in.f64();
+        player.isHost = in.u8() != 0;
+        player.isActive = in.u8() != 0;
+        game->players.push_back(std::move(player));
+    }
+
+    game->deck = readCards(in);
+
+    uint32_t handCount = in.u32();
+    for (uint32_t i = 0; i < handCount; ++i) {
+        std::string playerId = in.str();
+        game->currentHands[playerId] = readCards(in);
+    }
+
+    uint32_t decisionCount = in.u32();
+    for (uint32_t i = 0; i < decisionCount; ++i) {
+        std::string playerId = in.str();
+        game->decisions[playerId] = in.u8() ? "hold" : "drop";
+    }
+
+    if (in.remaining() != 0) throw std::runtime_error("Trailing bytes in game record");
+    return game;
+}
+
+} // namespace guts
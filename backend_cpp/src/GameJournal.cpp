@@ -0,0 +1,293 @@
+#include "GameJournal.hpp"
+#include "GameCodec.hpp"
+#include "Metrics.hpp"
+#include <zlib.h>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace guts {
+
+namespace {
+
+// Record framing: [u32 payload length][u32 crc32 of payload][payload]
+// payload: [u8 type][str roomCode][str reason][str blob]
+constexpr uint8_t kPutRoom = 1;
+constexpr uint8_t kRemoveRoom = 2;
+constexpr uint32_t kMaxRecordBytes = 16u << 20;
+constexpr size_t kSnapshotChunkBytes = 1 << 20;
+
+void appendRecord(std::string& out, uint8_t type, const std::string& roomCode,
+                  const char* reason, const std::string& blob) {
+    std::string payload;
+    payload.reserve(16 + roomCode.size() + blob.size());
+    BinaryWriter writer(payload);
+    writer.u8(type);
+    writer.str(roomCode);
+    writer.str(reason);
+    writer.str(blob);
+
+    BinaryWriter frame(out);
+    frame.u32(static_cast<uint32_t>(payload.size()));
+    frame.u32(static_cast<uint32_t>(crc32(0, reinterpret_cast<const Bytef*>(payload.data()),
+                                          static_cast<uInt>(payload.size()))));
+    out.append(payload);
+}
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+} // namespace
+
+GameJournal::GameJournal(Options options)
+    : options_(std::move(options)), lastSnapshot_(std::chrono::steady_clock::now()) {
+    if (::mkdir(options_.directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        throw std::runtime_error("Cannot create journal directory " + options_.directory +
+                                 ": " + std::strerror(errno));
+    }
+}
+
+GameJournal::~GameJournal() {
+    stop();
+}
+
+std::string GameJournal::logPath() const {
+    return options_.directory + "/journal.wal";
+}
+
+std::string GameJournal::snapshotPath() const {
+    return options_.directory + "/snapshot.bin";
+}
+
+std::map<std::string, std::string> GameJournal::recover() {
+    latest_.clear();
+    readRecords(snapshotPath(), false);
+    readRecords(logPath(), true);
+    return latest_;
+}
+
+bool GameJournal::readRecords(const std::string& path, bool truncateTornTail) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    const std::string data = contents.str();
+
+    size_t offset = 0;
+    while (data.size() - offset >= 8) {
+        BinaryReader header(data.data() + offset, 8);
+        uint32_t length = header.u32();
+        uint32_t checksum = header.u32();
+        if (length > kMaxRecordBytes || data.size() - offset - 8 < length) break;
+
+        const char* payload = data.data() + offset + 8;
+        if (crc32(0, reinterpret_cast<const Bytef*>(payload), length) != checksum) break;
+
+        try {
+            BinaryReader reader(payload, length);
+            uint8_t type = reader.u8();
+            std::string roomCode = reader.str();
+            reader.str(); // reason, for humans reading the log
+            std::string blob = reader.str();
+
+            if (type == kPutRoom) {
+                latest_[roomCode] = std::move(blob);
+            } else if (type == kRemoveRoom) {
+                latest_.erase(roomCode);
+            } else {
+                break;
+            }
+        } catch (const std::exception&) {
+            break;
+        }
+        offset += 8 + length;
+    }
+
+    if (offset < data.size()) {
+        std::cerr << "Journal: ignoring " << (data.size() - offset) << " bytes of torn or corrupt records at the end of "
+                  << path << std::endl;
+        if (truncateTornTail && ::truncate(path.c_str(), static_cast<off_t>(offset)) != 0) {
+            std::cerr << "Journal: cannot truncate " << path << ": " << std::strerror(errno) << std::endl;
+        }
+    }
+    return true;
+}
+
+void GameJournal::start() {
+    logFd_ = ::open(logPath().c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (logFd_ < 0) {
+        throw std::runtime_error("Cannot open " + logPath() + ": " + std::strerror(errno));
+    }
+
+    struct stat info;
+    logBytes_ = ::fstat(logFd_, &info) == 0 ? static_cast<uint64_t>(info.st_size) : 0;
+    lastSnapshot_ = std::chrono::steady_clock::now();
+    writer_ = std::thread([this]() { run(); });
+}
+
+void GameJournal::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) return;
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    if (writer_.joinable()) writer_.join();
+
+    if (logFd_ >= 0) {
+        if (logBytes_ > 0) writeSnapshot();
+        ::close(logFd_);
+        logFd_ = -1;
+    }
+}
+
+void GameJournal::append(const std::string& roomCode, std::string blob, const char* reason) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.push_back({roomCode, std::move(blob), reason});
+    }
+    queueDepth_.fetch_add(1, std::memory_order_relaxed);
+    wake_.notify_one();
+}
+
+void GameJournal::run() {
+    std::vector<Pending> batch;
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true) {
+        // Wake at least once a second so the snapshot interval is honored
+        wake_.wait_for(lock, std::chrono::seconds(1), [this]() { return stopping_ || !pending_.empty(); });
+        if (pending_.empty() && stopping_) break;
+
+        // Whatever queued up while the last batch was syncing goes out together
+        batch.swap(pending_);
+        lock.unlock();
+
+        if (!batch.empty()) {
+            writeBatch(batch);
+            batch.clear();
+        }
+
+        auto sinceSnapshot = std::chrono::duration<double>(std::chrono::steady_clock::now() - lastSnapshot_).count();
+        if (snapshotOwed_ || (logBytes_ > 0 && (logBytes_ >= options_.snapshotLogBytes ||
+                                                sinceSnapshot >= options_.snapshotIntervalSeconds))) {
+            writeSnapshot();
+        }
+
+        lock.lock();
+    }
+}
+
+void GameJournal::writeBatch(std::vector<Pending>& batch) {
+    std::string buffer;
+    for (auto& record : batch) {
+        bool removed = record.blob.empty();
+        appendRecord(buffer, removed ? kRemoveRoom : kPutRoom, record.roomCode, record.reason, record.blob);
+        if (removed) {
+            latest_.erase(record.roomCode);
+        } else {
+            latest_[record.roomCode] = std::move(record.blob);
+        }
+    }
+
+    bool ok = writeAll(logFd_, buffer.data(), buffer.size());
+    if (ok && options_.sync) ok = ::fdatasync(logFd_) == 0;
+    if (ok) {
+        logBytes_ += buffer.size();
+    } else {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+        std::cerr << "Journal: write to " << logPath() << " failed: " << std::strerror(errno) << std::endl;
+
+        // Recovery stops at the first torn frame, so cut it off before
+        // anything else lands behind it (O_APPEND writes follow the new end).
+        // The batch is in latest_; a snapshot makes it durable and, if the
+        // truncate failed, empties the log anyway. Until one succeeds the
+        // writer retries it every pass.
+        if (::ftruncate(logFd_, static_cast<off_t>(logBytes_)) != 0) {
+            std::cerr << "Journal: cannot cut torn write from " << logPath() << ": " << std::strerror(errno) << std::endl;
+        }
+        snapshotOwed_ = true;
+        writeSnapshot();
+    }
+
+    queueDepth_.fetch_sub(batch.size(), std::memory_order_relaxed);
+    records_.fetch_add(batch.size(), std::memory_order_relaxed);
+    batches_.fetch_add(1, std::memory_order_relaxed);
+    bytes_.fetch_add(buffer.size(), std::memory_order_relaxed);
+}
+
+void GameJournal::writeSnapshot() {
+    std::string tmpPath = snapshotPath() + ".tmp";
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    bool ok = fd >= 0;
+
+    std::string buffer;
+    for (const auto& [roomCode, blob] : latest_) {
+        if (!ok) break;
+        appendRecord(buffer, kPutRoom, roomCode, "snapshot", blob);
+        if (buffer.size() >= kSnapshotChunkBytes) {
+            ok = writeAll(fd, buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+    if (ok) ok = writeAll(fd, buffer.data(), buffer.size());
+    if (ok) ok = ::fdatasync(fd) == 0;
+    if (fd >= 0) ::close(fd);
+
+    // The rename publishes the snapshot atomically; only then is the log
+    // redundant. A crash in between replays the old log on top, which is
+    // harmless because records are whole room images.
+    if (ok) ok = ::rename(tmpPath.c_str(), snapshotPath().c_str()) == 0;
+    if (ok) {
+        int dirFd = ::open(options_.directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirFd >= 0) {
+            ::fsync(dirFd);
+            ::close(dirFd);
+        }
+        ok = ::ftruncate(logFd_, 0) == 0;
+    }
+
+    if (!ok) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+        std::cerr << "Journal: snapshot to " << snapshotPath() << " failed: " << std::strerror(errno) << std::endl;
+    } else {
+        logBytes_ = 0;
+        snapshotOwed_ = false;
+        snapshots_.fetch_add(1, std::memory_order_relaxed);
+    }
+    lastSnapshot_ = std::chrono::steady_clock::now();
+}
+
+void GameJournal::renderPrometheus(std::string& out) const {
+    metrics::appendMetricHeader(out, "guts_journal_records_total", "Room records appended to the write-ahead log", "counter");
+    metrics::appendSample(out, "guts_journal_records_total", "", static_cast<double>(records_.load(std::memory_order_relaxed)));
+    metrics::appendMetricHeader(out, "guts_journal_batches_total", "Group commits (one write and sync each)", "counter");
+    metrics::appendSample(out, "guts_journal_batches_total", "", static_cast<double>(batches_.load(std::memory_order_relaxed)));
+    metrics::appendMetricHeader(out, "guts_journal_bytes_total", "Bytes appended to the write-ahead log", "counter");
+    metrics::appendSample(out, "guts_journal_bytes_total", "", static_cast<double>(bytes_.load(std::memory_order_relaxed)));
+    metrics::appendMetricHeader(out, "guts_journal_snapshots_total", "Snapshots written", "counter");
+    metrics::appendSample(out, "guts_journal_snapshots_total", "", static_cast<double>(snapshots_.load(std::memory_order_relaxed)));
+    metrics::appendMetricHeader(out, "guts_journal_errors_total", "Failed log writes or snapshots", "counter");
+    metrics::appendSample(out, "guts_journal_errors_total", "", static_cast<double>(errors_.load(std::memory_order_relaxed)));
+    metrics::appendMetricHeader(out, "guts_journal_queue_depth", "Records waiting for the writer", "gauge");
+    metrics::appendSample(out, "guts_journal_queue_depth", "", static_cast<double>(queueDepth_.load(std::memory_order_relaxed)));
+}
+
+} // namespace guts
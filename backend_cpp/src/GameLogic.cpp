@@ -1,5 +1,4 @@
 #include "GameLogic.hpp"
-#include <openssl/rand.h>
 #include <stdexcept>
 #include <map>
 
@@ -32,21 +31,14 @@ std::vector<Card> GameLogic::createDeck() {
 }
 
 void GameLogic::shuffleDeck(std::vector<Card>& deck) {
-    // Use Fisher-Yates shuffle with cryptographically secure random
+    thread_local SecureRandom secure;
+    shuffleDeck(deck, secure);
+}
+
+void GameLogic::shuffleDeck(std::vector<Card>& deck, RandomSource& source) {
+    // Fisher-Yates shuffle
     for (size_t i = deck.size() - 1; i > 0; --i) {
-        // Generate cryptographically secure random index
-        unsigned char randomBytes[4];
-        if (RAND_bytes(randomBytes, 4) != 1) {
-            throw std::runtime_error("Failed to generate secure random bytes");
-        }
-        
-        uint32_t randomValue = 
-            (static_cast<uint32_t>(randomBytes[0]) << 24) |
-            (static_cast<uint32_t>(randomBytes[1]) << 16) |
-            (static_cast<uint32_t>(randomBytes[2]) << 8) |
-            static_cast<uint32_t>(randomBytes[3]);
-        
-        size_t j = randomValue % (i + 1);
+        size_t j = static_cast<size_t>(source.uniform(i + 1));
         std::swap(deck[i], deck[j]);
     }
 }
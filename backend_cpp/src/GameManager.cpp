@@ -1,5 +1,8 @@
 #include "GameManager.hpp"
-#include <random>
+#include "GameCodec.hpp"
+#include "Metrics.hpp"
+#include "Tracing.hpp"
+#include "AllocAccounting.hpp"
 #include <algorithm>
 #include <thread>
 #include <chrono>
@@ -7,58 +10,379 @@
 
 namespace guts {
 
-// Helper function to generate UUID
-std::string generateUUID() {
-    static std::random_device rd;
-    static std::mt19937_64 gen(rd());
-    static std::uniform_int_distribution<uint64_t> dis;
-    
-    uint64_t part1 = dis(gen);
-    uint64_t part2 = dis(gen);
-    
-    char buffer[37];
-    snprintf(buffer, sizeof(buffer),
-        "%08lx-%04lx-%04lx-%04lx-%012lx",
-        (part1 >> 32) & 0xFFFFFFFF,
-        (part1 >> 16) & 0xFFFF,
-        part1 & 0xFFFF,
-        (part2 >> 48) & 0xFFFF,
-        part2 & 0xFFFFFFFFFFFF);
-    
-    return std::string(buffer);
+namespace {
+
+// libstdc++ sizes behind the estimates in RoomSummary
+constexpr size_t kMapNodeOverhead = 32;    // red-black tree node header
+constexpr size_t kSsoCapacity = 15;        // strings this short live inline
+constexpr size_t kPendingTimerBytes = 192; // trantor timer, queue entry and callback
+
+size_t heapBytes(const std::string& text) {
+    return text.capacity() > kSsoCapacity ? text.capacity() + 1 : 0;
+}
+
+size_t heapBytes(const std::vector<Card>& cards) {
+    size_t bytes = cards.capacity() * sizeof(Card);
+    for (const auto& card : cards) bytes += heapBytes(card.rank);
+    return bytes;
+}
+
+size_t heapBytes(const nlohmann::json& value) {
+    switch (value.type()) {
+        case nlohmann::json::value_t::object: {
+            const auto& object = value.get_ref<const nlohmann::json::object_t&>();
+            size_t bytes = sizeof(object);
+            for (const auto& [key, member] : object) {
+                bytes += kMapNodeOverhead + sizeof(key) + heapBytes(key) + sizeof(member) + heapBytes(member);
+            }
+            return bytes;
+        }
+        case nlohmann::json::value_t::array: {
+            const auto& array = value.get_ref<const nlohmann::json::array_t&>();
+            size_t bytes = sizeof(array) + array.capacity() * sizeof(nlohmann::json);
+            for (const auto& element : array) bytes += heapBytes(element);
+            return bytes;
+        }
+        case nlohmann::json::value_t::string: {
+            const auto& text = value.get_ref<const nlohmann::json::string_t&>();
+            return sizeof(text) + heapBytes(text);
+        }
+        case nlohmann::json::value_t::binary:
+            return sizeof(nlohmann::json::binary_t) + value.get_binary().capacity();
+        default:
+            return 0;
+    }
+}
+
+} // namespace
+
+GameManager::GameManager(MessageCallback msgCallback, BroadcastCallback broadcastCallback,
+                         ScheduleCallback scheduleCallback)
+    : sendMessage_(msgCallback), broadcastToRoom_(broadcastCallback),
+      schedule_(scheduleCallback), random_(std::make_unique<SecureRandom>()) {
+}
+
+void GameManager::setRandomSeed(uint64_t seed) {
+    setRandomSeed(seed, seed);
 }
 
-GameManager::GameManager(MessageCallback msgCallback, BroadcastCallback broadcastCallback)
-    : sendMessage_(msgCallback), broadcastToRoom_(broadcastCallback) {
+void GameManager::setRandomSeed(uint64_t codeSeed, uint64_t roomSeed) {
+    seeded_ = true;
+    seed_ = roomSeed;
+    random_ = std::make_unique<SeededRandom>(codeSeed);
 }
 
-std::string GameManager::generateRoomCode() {
+void GameManager::runAfter(double delaySeconds, std::function<void()> task) {
+    if (schedule_) {
+        schedule_(delaySeconds, std::move(task));
+        return;
+    }
+    
+    // No event loop provided - fall back to a sleeping thread
+    std::thread([delaySeconds, task = std::move(task)]() {
+        std::this_thread::sleep_for(std::chrono::duration<double>(delaySeconds));
+        task();
+    }).detach();
+}
+
+void GameManager::runForRoom(Game* game, double delaySeconds, std::function<void()> task) {
+    ++game->pendingTimers;
+    runAfter(delaySeconds, [this, roomCode = game->roomCode, task = std::move(task)]() {
+        auto it = games_.find(roomCode);
+        Game* g = it != games_.end() ? it->second.get() : nullptr;
+        if (g && g->pendingTimers > 0) --g->pendingTimers;
+        RoomMutation mutation(*this, g);
+        task();
+    });
+}
+
+GameManager::RoomMutation::RoomMutation(GameManager& manager, Game* game)
+    : manager_(manager), outer_(manager.mutation_) {
+    if (game) roomCode_ = game->roomCode;
+    manager_.mutation_ = this;
+}
+
+GameManager::RoomMutation::~RoomMutation() {
+    manager_.mutation_ = outer_;
+    if (!modified_ || roomCode_.empty()) return;
+    // The room may have been removed meanwhile
+    if (Game* game = manager_.awakeGame(roomCode_)) game->markDirty();
+}
+
+void GameManager::modified(Game* game) {
+    game->markDirty();
+    if (mutation_) mutation_->markModified();
+}
+
+void GameManager::runPhaseAfter(Game* game, const char* phase, double delaySeconds, std::function<void()> task) {
+    auto scheduledAt = tracing::Clock::now();
+    runForRoom(game, delaySeconds, [this, phase, delaySeconds, scheduledAt, roomCode = game->roomCode,
+                                    round = game->round, task = std::move(task)]() {
+        if (frozen_) return;
+        tracing::complete(phase, roomCode, round, scheduledAt, tracing::Clock::now(), delaySeconds * 1000.0);
+        alloc::AllocScope allocScope(phase);
+        task();
+    });
+}
+
+void GameManager::finishRoundTrace(Game* game) {
+    tracing::complete("round", game->roomCode, game->round, game->roundStartedAt, tracing::Clock::now());
+}
+
+std::string GameManager::generateRoomCode(const std::function<bool(const std::string&)>& accept,
+                                          const std::string& prefix) {
     static const char chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> dis(0, sizeof(chars) - 2);
     
     std::string code;
     do {
-        code.clear();
-        for (int i = 0; i < 6; ++i) {
-            code += chars[dis(gen)];
+        code = prefix;
+        while (code.size() < 6) {
+            code += chars[random_->uniform(sizeof(chars) - 1)];
         }
-    } while (games_.find(code) != games_.end());
+    } while (games_.find(code) != games_.end() || hibernated_.find(code) != hibernated_.end() ||
+             (accept && !accept(code)));
     
     return code;
 }
 
 void GameManager::createGame(const std::string& roomCode, const std::string& hostToken) {
-    games_[roomCode] = std::make_unique<Game>(roomCode, hostToken);
+    auto game = std::make_unique<Game>(roomCode, hostToken);
+    attachRandomSource(game.get());
+    journal(game.get(), "create_room");
+    games_[roomCode] = std::move(game);
+}
+
+void GameManager::restoreGame(std::unique_ptr<Game> game) {
+    bool voided = game->roundInFlight;
+    if (voided) {
+        for (const auto& [playerId, cards] : game->currentHands) {
+            Player* player = game->findPlayerById(playerId);
+            if (!player) continue;
+            player->balance += game->ante;
+            game->pot -= game->ante;
+            // Undo the elimination check that followed the ante
+            if (player->balance >= game->ante) player->isActive = true;
+        }
+        game->round = std::max(0, game->round - 1);
+        game->roundInFlight = false;
+    }
+    game->roundResolved = true;
+    game->pendingGameEnd = game->pendingGameEnd && !voided;
+    game->deck.clear();
+    game->currentHands.clear();
+    game->decisions.clear();
+    for (auto& player : game->players) {
+        player.socketId.clear();
+        player.awaitingReconnect = false;
+    }
+    
+    attachRandomSource(game.get());
+    
+    if (voided) journal(game.get(), "round_voided");
+    std::string roomCode = game->roomCode;
+    games_[roomCode] = std::move(game);
+}
+
+void GameManager::attachRandomSource(Game* game) {
+    if (seeded_) {
+        game->random = std::make_unique<SeededRandom>(deriveSeed(seed_, game->roomCode));
+    } else {
+        game->random = std::make_unique<SecureRandom>();
+    }
+}
+
+void GameManager::journal(const Game* game, const char* reason) {
+    if (journal_) journal_(game->roomCode, game, reason);
+}
+
+void GameManager::journalRemoved(const std::string& roomCode, const char* reason) {
+    if (journal_) journal_(roomCode, nullptr, reason);
+}
+
+void GameManager::recordHand(Game* game, HandOutcome outcome, double potBefore, const std::string& winnerId,
+                             std::vector<Card> deckCards) {
+    if (playerStats_) {
+        for (const auto& [playerId, cards] : game->currentHands) {
+            const Player* player = game->findPlayerById(playerId);
+            if (!player) continue;
+            auto startIt = game->roundStartBalances.find(playerId);
+            PlayerStatsUpdate update;
+            update.token = player->token;
+            update.name = player->name;
+            update.net = startIt != game->roundStartBalances.end() ? player->balance - startIt->second : 0.0;
+            update.beatDeck = outcome == HandOutcome::DeckWin && playerId == winnerId;
+            playerStats_(std::move(update));
+        }
+    }
+    if (!handHistory_) return;
+    
+    // Only copies here; the writer thread evaluates and encodes
+    HandRecord record;
+    record.roomCode = game->roomCode;
+    record.round = game->round;
+    record.timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    record.isNothingRound = game->isNothingRound;
+    record.outcome = outcome;
+    record.ante = game->ante;
+    record.potBefore = potBefore;
+    record.potAfter = game->pot;
+    record.winnerId = winnerId;
+    record.deckCards = std::move(deckCards);
+    
+    record.players.reserve(game->currentHands.size());
+    for (const auto& [playerId, cards] : game->currentHands) {
+        const Player* player = game->findPlayerById(playerId);
+        HandRecordPlayer entry;
+        entry.id = playerId;
+        entry.cards = cards;
+        auto decisionIt = game->decisions.find(playerId);
+        entry.decision = decisionIt != game->decisions.end() ? decisionIt->second : "drop";
+        auto startIt = game->roundStartBalances.find(playerId);
+        if (player) {
+            entry.name = player->name;
+            entry.balanceAfter = player->balance;
+        }
+        entry.balanceBefore = startIt != game->roundStartBalances.end() ? startIt->second : entry.balanceAfter;
+        record.players.push_back(std::move(entry));
+    }
+    
+    handHistory_(std::move(record));
+}
+
+std::vector<std::pair<std::string, std::string>> GameManager::exportRooms() const {
+    std::vector<std::pair<std::string, std::string>> rooms;
+    rooms.reserve(games_.size() + hibernated_.size());
+    for (const auto& [roomCode, game] : games_) {
+        rooms.emplace_back(roomCode, encodeGame(*game));
+    }
+    for (const auto& [roomCode, room] : hibernated_) {
+        rooms.emplace_back(roomCode, room.blob);
+    }
+    return rooms;
 }
 
 Game* GameManager::getGame(const std::string& roomCode) {
+    if (Game* game = awakeGame(roomCode)) return game;
+    
+    auto sleeping = hibernated_.find(roomCode);
+    return sleeping != hibernated_.end() ? wake(sleeping) : nullptr;
+}
+
+Game* GameManager::awakeGame(const std::string& roomCode) {
     auto it = games_.find(roomCode);
     return it != games_.end() ? it->second.get() : nullptr;
 }
 
+size_t GameManager::hibernateIdleRooms(std::chrono::seconds idleFor) {
+    if (frozen_) return 0;
+    auto now = std::chrono::system_clock::now();
+    
+    size_t count = 0;
+    for (auto it = games_.begin(); it != games_.end();) {
+        const Game& game = *it->second;
+        bool inUse = game.roundInFlight || game.pendingTimers > 0 || now - game.lastActivity < idleFor ||
+            std::any_of(game.players.begin(), game.players.end(), [](const Player& player) {
+                return !player.socketId.empty() || player.awaitingReconnect;
+            });
+        if (inUse) {
+            ++it;
+            continue;
+        }
+        
+        // Nothing durable changes, so the journal already has this image
+        HibernatedRoom room{encodeGame(game), summarize(game)};
+        room.summary.hibernated = true;
+        room.summary.gameBytes = sizeof(HibernatedRoom) + heapBytes(room.blob);
+        room.summary.eventLogBytes = 0;
+        metrics::adjust(metrics::Gauge::HibernatedBytes, static_cast<int64_t>(room.blob.size()));
+        hibernated_.emplace(it->first, std::move(room));
+        it = games_.erase(it);
+        ++count;
+    }
+    
+    if (count > 0) {
+        metrics::adjust(metrics::Gauge::HibernatedRooms, static_cast<int64_t>(count));
+        metrics::increment(metrics::Counter::RoomsHibernated, count);
+    }
+    return count;
+}
+
+Game* GameManager::wake(std::map<std::string, HibernatedRoom>::iterator it) {
+    std::unique_ptr<Game> game;
+    try {
+        game = decodeGame(it->second.blob);
+    } catch (const std::exception& e) {
+        std::cerr << "Dropping unreadable hibernated room " << it->first << ": " << e.what() << std::endl;
+        std::string roomCode = it->first;
+        forgetHibernated(it);
+        journalRemoved(roomCode, "abandoned");
+        return nullptr;
+    }
+    
+    attachRandomSource(game.get());
+    std::string roomCode = it->first;
+    forgetHibernated(it);
+    metrics::increment(metrics::Counter::RoomsWoken);
+    
+    Game* awake = game.get();
+    games_[roomCode] = std::move(game);
+    return awake;
+}
+
+void GameManager::forgetHibernated(std::map<std::string, HibernatedRoom>::iterator it) {
+    metrics::adjust(metrics::Gauge::HibernatedRooms, -1);
+    metrics::adjust(metrics::Gauge::HibernatedBytes, -static_cast<int64_t>(it->second.blob.size()));
+    hibernated_.erase(it);
+}
+
+void GameManager::broadcastEvent(Game* game, const std::string& event, nlohmann::json data) {
+    data["seq"] = game->eventLog.nextSeq();
+    game->eventLog.append(event, data);
+    broadcastToRoom_(game->roomCode, event, data);
+}
+
+void GameManager::sendPlayerEvent(Game* game, const Player& player, const std::string& event, nlohmann::json data) {
+    // Logged even while the player is disconnected so they get it on resume
+    data["seq"] = game->eventLog.nextSeq();
+    game->eventLog.append(event, data, player.id);
+    if (!player.socketId.empty()) {
+        sendMessage_(player.socketId, event, data);
+    }
+}
+
+void GameManager::sendWithPlayers(const std::string& socketId, const std::string& event, const nlohmann::json& data,
+                                  Game* game) {
+    // Splice the cached player array into the dumped object instead of
+    // copying it into `data` and serializing it again
+    const std::string& players = game->serializedPlayers();
+    std::string text = data.dump();
+    text.pop_back();
+    text.reserve(text.size() + players.size() + 16);
+    text += data.empty() ? "\"players\":" : ",\"players\":";
+    text += players;
+    text += '}';
+    
+    if (sendRawMessage_) {
+        sendRawMessage_(socketId, event, text);
+    } else {
+        sendMessage_(socketId, event, nlohmann::json::parse(text));
+    }
+}
+
+void GameManager::sendRemainingTimer(const std::string& socketId, const Game* game) {
+    auto remaining = std::chrono::duration_cast<std::chrono::seconds>(
+        game->decisionDeadline - std::chrono::steady_clock::now()).count();
+    sendMessage_(socketId, "timer_started", {
+        {"duration", std::clamp<long long>(remaining, 0, kDecisionSeconds)},
+        {"round", game->round}
+    });
+}
+
 void GameManager::handleJoinRoom(const std::string& socketId, const nlohmann::json& data) {
+    metrics::ScopedLatency latency(metrics::Stage::Handle, "join_room");
+    alloc::AllocScope allocScope("join_room");
+    if (frozen_) return;
     if (!data.contains("roomCode") || !data.contains("playerToken") || !data.contains("playerName")) {
         sendMessage_(socketId, "error", {{"message", "Missing required fields"}});
         return;
@@ -73,6 +397,7 @@ void GameManager::handleJoinRoom(const std::string& socketId, const nlohmann::js
         sendMessage_(socketId, "error", {{"message", "Game not found"}});
         return;
     }
+    RoomMutation mutation(*this, game);
     
     // Check if player already exists (reconnection)
     Player* player = game->findPlayerByToken(playerToken);
@@ -89,8 +414,9 @@ void GameManager::handleJoinRoom(const std::string& socketId, const nlohmann::js
             return;
         }
         
+        modified(game);
         Player newPlayer;
-        newPlayer.id = generateUUID();
+        newPlayer.id = generateUUID(*game->random);
         newPlayer.token = playerToken;
         newPlayer.name = playerName;
         newPlayer.balance = 0.0;
@@ -103,33 +429,46 @@ void GameManager::handleJoinRoom(const std::string& socketId, const nlohmann::js
         player = &game->players.back();
     } else {
         // Reconnection
+        modified(game);
         player->socketId = socketId;
         player->isActive = true;
+        player->awaitingReconnect = false;
         player->name = playerName;
         
         if (player->buyInAmount == 0) {
             player->buyInAmount = 20.0;
         }
         
-        // If reconnecting during active game, send current game state
-        // Only send round state if game is actually in a valid playing state
-        if (game->state == GameState::PLAYING && game->round > 0) {
-            nlohmann::json playersJson = nlohmann::json::array();
-            for (const auto& p : game->players) {
-                playersJson.push_back({
-                    {"id", p.id},
-                    {"name", p.name},
-                    {"balance", p.balance},
-                    {"isActive", p.isActive}
-                });
+        // Resume from the client's last-seen event if the log still covers it
+        bool resumed = false;
+        if (data.contains("lastSeq") && data["lastSeq"].is_number_integer() && data["lastSeq"] >= 0) {
+            std::vector<const RoomEvent*> missed;
+            if (game->eventLog.eventsSince(data["lastSeq"].get<uint64_t>(), player->id, missed)) {
+                // The logged timer_started carries the full duration; resend it
+                // with what's left instead
+                bool timerMissed = false;
+                for (const auto* e : missed) {
+                    if (e->event == "timer_started" && e->data.value("round", -1) == game->round) {
+                        timerMissed = true;
+                        continue;
+                    }
+                    sendMessage_(socketId, e->event, e->data);
+                }
+                if (timerMissed && game->state == GameState::PLAYING && !game->roundResolved) {
+                    sendRemainingTimer(socketId, game);
+                }
+                resumed = true;
             }
-            
-            sendMessage_(socketId, "round_started", {
+        }
+        
+        // Otherwise fall back to a snapshot of the current game state
+        // Only send round state if game is actually in a valid playing state
+        if (!resumed && game->state == GameState::PLAYING && game->round > 0) {
+            sendWithPlayers(socketId, "round_started", {
                 {"round", game->round},
                 {"pot", game->pot},
-                {"isNothingRound", game->isNothingRound},
-                {"players", playersJson}
-            });
+                {"isNothingRound", game->isNothingRound}
+            }, game);
             
             // Send player's cards if they have them (only if round is active)
             auto handIt = game->currentHands.find(player->id);
@@ -147,10 +486,7 @@ void GameManager::handleJoinRoom(const std::string& socketId, const nlohmann::js
                 });
                 
                 // Only send timer if we're in an active round with cards
-                sendMessage_(socketId, "timer_started", {
-                    {"duration", 30},
-                    {"round", game->round}
-                });
+                sendRemainingTimer(socketId, game);
             }
         } else if (game->state == GameState::PLAYING && game->round == 0) {
             // Game state is invalid (playing but no round) - reset to lobby
@@ -167,31 +503,19 @@ void GameManager::handleJoinRoom(const std::string& socketId, const nlohmann::js
     game->lastActivity = std::chrono::system_clock::now();
     
     // Send confirmation to joining player
-    nlohmann::json playersJson = nlohmann::json::array();
-    for (const auto& p : game->players) {
-        playersJson.push_back({
-            {"id", p.id},
-            {"name", p.name},
-            {"isHost", p.isHost},
-            {"balance", p.balance},
-            {"buyInAmount", p.buyInAmount}
-        });
-    }
-    
-    sendMessage_(socketId, "room_joined", {
+    sendWithPlayers(socketId, "room_joined", {
         {"playerId", player->id},
-        {"players", playersJson},
+        {"seq", game->eventLog.lastSeq()},
         {"gameState", {
-            {"state", game->state == GameState::LOBBY ? "lobby" : 
-                     (game->state == GameState::PLAYING ? "playing" : "ended")},
+            {"state", getGameStateName(game->state)},
             {"round", game->round},
             {"pot", game->pot},
             {"buyInAmount", player->buyInAmount}
         }}
-    });
+    }, game);
     
     // Notify all other players
-    broadcastToRoom_(roomCode, "player_joined", {
+    broadcastEvent(game, "player_joined", {
         {"player", {
             {"id", player->id},
             {"name", player->name},
@@ -200,9 +524,12 @@ void GameManager::handleJoinRoom(const std::string& socketId, const nlohmann::js
             {"buyInAmount", player->buyInAmount}
         }}
     });
+    journal(game, "join_room");
 }
 
 void GameManager::handleSetBuyIn(const std::string& socketId, const nlohmann::json& data) {
+    metrics::ScopedLatency latency(metrics::Stage::Handle, "set_buy_in");
+    alloc::AllocScope allocScope("set_buy_in");
     auto roomIt = socketToRoomCode_.find(socketId);
     if (roomIt == socketToRoomCode_.end()) return;
     
@@ -211,6 +538,7 @@ void GameManager::handleSetBuyIn(const std::string& socketId, const nlohmann::js
     
     Game* game = getGame(roomIt->second);
     if (!game) return;
+    RoomMutation mutation(*this, game);
     
     Player* player = game->findPlayerById(playerIdIt->second);
     if (!player) return;
@@ -223,27 +551,22 @@ void GameManager::handleSetBuyIn(const std::string& socketId, const nlohmann::js
         return;
     }
     
+    modified(game);
     player->buyInAmount = buyInAmount;
     
-    nlohmann::json playersJson = nlohmann::json::array();
-    for (const auto& p : game->players) {
-        playersJson.push_back({
-            {"id", p.id},
-            {"name", p.name},
-            {"isHost", p.isHost},
-            {"balance", p.balance},
-            {"buyInAmount", p.buyInAmount}
-        });
-    }
+    const auto& playersJson = game->publicSnapshot().players;
     
-    broadcastToRoom_(game->roomCode, "buy_in_updated", {
+    broadcastEvent(game, "buy_in_updated", {
         {"playerId", player->id},
         {"buyInAmount", buyInAmount},
         {"players", playersJson}
     });
+    journal(game, "set_buy_in");
 }
 
 void GameManager::handleStartGame(const std::string& socketId, const nlohmann::json& data) {
+    metrics::ScopedLatency latency(metrics::Stage::Handle, "start_game");
+    alloc::AllocScope allocScope("start_game");
     auto roomIt = socketToRoomCode_.find(socketId);
     if (roomIt == socketToRoomCode_.end()) return;
     
@@ -252,6 +575,7 @@ void GameManager::handleStartGame(const std::string& socketId, const nlohmann::j
     
     Game* game = getGame(roomIt->second);
     if (!game) return;
+    RoomMutation mutation(*this, game);
     
     Player* player = game->findPlayerById(playerIdIt->second);
     if (!player || !player->isHost) {
@@ -272,6 +596,7 @@ void GameManager::handleStartGame(const std::string& socketId, const nlohmann::j
         }
     }
     
+    modified(game);
     game->state = GameState::PLAYING;
     game->round = 0;
     game->pot = 0.0;
@@ -287,31 +612,26 @@ void GameManager::handleStartGame(const std::string& socketId, const nlohmann::j
         p.isActive = true;
     }
     
-    nlohmann::json playersJson = nlohmann::json::array();
-    for (const auto& p : game->players) {
-        playersJson.push_back({
-            {"id", p.id},
-            {"name", p.name},
-            {"balance", p.balance},
-            {"buyInAmount", p.buyInAmount}
-        });
-    }
+    const auto& playersJson = game->publicSnapshot().players;
     
-    broadcastToRoom_(game->roomCode, "game_started", {{"players", playersJson}});
+    broadcastEvent(game, "game_started", {{"players", playersJson}});
+    journal(game, "start_game");
     
     // Start first round after a delay
-    std::thread([this, roomCode = game->roomCode]() {
-        std::this_thread::sleep_for(std::chrono::milliseconds(2000));
-        Game* g = getGame(roomCode);
+    runPhaseAfter(game, "wait_first_round", 2.0, [this, roomCode = game->roomCode]() {
+        Game* g = awakeGame(roomCode);
         if (g) startNewRound(g);
-    }).detach();
+    });
 }
 
 void GameManager::startNewRound(Game* game) {
+    modified(game);
     game->round++;
     game->isNothingRound = game->round <= 3;
     game->decisions.clear();
     game->currentHands.clear();
+    game->roundStartedAt = tracing::Clock::now();
+    tracing::Span span("start_new_round", game->roomCode, game->round);
     
     // Check for players in debt
     std::vector<Player*> playersInDebt;
@@ -331,15 +651,13 @@ void GameManager::startNewRound(Game* game) {
             });
             
             // Send debt notification to player
-            if (!p->socketId.empty()) {
-                sendMessage_(p->socketId, "player_in_debt", {
-                    {"debtAmount", std::abs(p->balance)},
-                    {"balance", p->balance}
-                });
-            }
+            sendPlayerEvent(game, *p, "player_in_debt", {
+                {"debtAmount", std::abs(p->balance)},
+                {"balance", p->balance}
+            });
         }
         
-        broadcastToRoom_(game->roomCode, "round_blocked_debt", {
+        broadcastEvent(game, "round_blocked_debt", {
             {"playersInDebt", debtPlayersJson}
         });
         return;
@@ -365,23 +683,26 @@ void GameManager::startNewRound(Game* game) {
                     {"neededAmount", game->ante}
                 });
                 
-                if (!p.socketId.empty()) {
-                    sendMessage_(p.socketId, "player_in_debt", {
-                        {"debtAmount", 0},
-                        {"balance", p.balance},
-                        {"needsBuyBack", true},
-                        {"anteAmount", game->ante}
-                    });
-                }
+                sendPlayerEvent(game, p, "player_in_debt", {
+                    {"debtAmount", 0},
+                    {"balance", p.balance},
+                    {"needsBuyBack", true},
+                    {"anteAmount", game->ante}
+                });
             }
         }
         
-        broadcastToRoom_(game->roomCode, "round_blocked_debt", {
+        broadcastEvent(game, "round_blocked_debt", {
             {"playersLowOnFunds", lowFundsJson}
         });
         return;
     }
     
+    game->roundStartBalances.clear();
+    for (const auto& p : game->players) {
+        game->roundStartBalances[p.id] = p.balance;
+    }
+    
     // Collect antes
     for (auto* p : activePlayers) {
         p->balance -= game->ante;
@@ -397,7 +718,7 @@ void GameManager::startNewRound(Game* game) {
     
     // Create and shuffle deck
     game->deck = GameLogic::createDeck();
-    GameLogic::shuffleDeck(game->deck);
+    GameLogic::shuffleDeck(game->deck, *game->random);
     
     // Deal cards to each active player
     for (auto* player : activePlayers) {
@@ -410,7 +731,7 @@ void GameManager::startNewRound(Game* game) {
             cardsJson.push_back(card.toJson());
         }
         
-        broadcastToRoom_(game->roomCode, "cards_dealt", {
+        broadcastEvent(game, "cards_dealt", {
             {"cards", cardsJson},
             {"round", game->round},
             {"isNothingRound", game->isNothingRound},
@@ -418,23 +739,18 @@ void GameManager::startNewRound(Game* game) {
         });
     }
     
+    game->roundResolved = false;
+    game->roundInFlight = true;
+    journal(game, "ante");
+    
     // Broadcast round start (after small delay)
-    std::thread([this, roomCode = game->roomCode]() {
-        std::this_thread::sleep_for(std::chrono::milliseconds(200));
-        Game* g = getGame(roomCode);
+    runPhaseAfter(game, "wait_round_started", 0.2, [this, roomCode = game->roomCode]() {
+        Game* g = awakeGame(roomCode);
         if (!g) return;
         
-        nlohmann::json playersJson = nlohmann::json::array();
-        for (const auto& p : g->players) {
-            playersJson.push_back({
-                {"id", p.id},
-                {"name", p.name},
-                {"balance", p.balance},
-                {"isActive", p.isActive}
-            });
-        }
+        const auto& playersJson = g->publicSnapshot().players;
         
-        broadcastToRoom_(roomCode, "round_started", {
+        broadcastEvent(g, "round_started", {
             {"round", g->round},
             {"pot", g->pot},
             {"isNothingRound", g->isNothingRound},
@@ -442,44 +758,63 @@ void GameManager::startNewRound(Game* game) {
         });
         
         startDecisionTimer(g);
-    }).detach();
+    });
 }
 
 void GameManager::startDecisionTimer(Game* game) {
     int currentRound = game->round;
-    broadcastToRoom_(game->roomCode, "timer_started", {
-        {"duration", 30},
+    game->decisionDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(kDecisionSeconds);
+    tracing::instant("timer_started", game->roomCode, currentRound);
+    broadcastEvent(game, "timer_started", {
+        {"duration", kDecisionSeconds},
         {"round", currentRound}
     });
     
-    // Start 30-second timer
-    std::thread([this, roomCode = game->roomCode, roundNumber = currentRound]() {
-        for (int remaining = 30; remaining > 0; --remaining) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-            Game* g = getGame(roomCode);
-            if (!g) return;
-            
-            // Only send tick if still on the same round
-            if (g->round == roundNumber) {
-                broadcastToRoom_(roomCode, "timer_tick", {
-                    {"remaining", remaining - 1},
-                    {"round", roundNumber}
-                });
-            } else {
-                // Round changed, stop this timer thread
-                return;
-            }
-        }
-        
-        Game* g = getGame(roomCode);
-        // Only resolve if still on the same round
-        if (g && g->round == roundNumber) {
-            resolveRound(g);
-        }
-    }).detach();
+    // Start 30-second timer, one tick per second
+    runForRoom(game, 1.0, [this, roomCode = game->roomCode, roundNumber = currentRound]() {
+        decisionTick(roomCode, roundNumber, kDecisionSeconds - 1);
+    });
+}
+
+void GameManager::decisionTick(const std::string& roomCode, int roundNumber, int remaining) {
+    alloc::AllocScope allocScope("decision_tick");
+    if (frozen_) return;
+    Game* g = awakeGame(roomCode);
+    // Round changed or game gone, stop this timer
+    if (!g || g->round != roundNumber) return;
+    
+    // Tick `remaining` is due `remaining` seconds before the deadline
+    auto due = g->decisionDeadline - std::chrono::seconds(remaining);
+    auto now = std::chrono::steady_clock::now();
+    if (now > due) {
+        metrics::recordTimerDrift(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - due).count()));
+    } else {
+        metrics::recordTimerDrift(0);
+    }
+    
+    expireDisconnectGrace(g);
+    if (g->roundResolved) return;
+    
+    // Ticks are transient and not kept in the event log
+    broadcastToRoom_(roomCode, "timer_tick", {
+        {"remaining", remaining},
+        {"round", roundNumber}
+    });
+    
+    if (remaining <= 0) {
+        resolveRound(g);
+        return;
+    }
+    
+    runForRoom(g, 1.0, [this, roomCode, roundNumber, remaining]() {
+        decisionTick(roomCode, roundNumber, remaining - 1);
+    });
 }
 
 void GameManager::handlePlayerDecision(const std::string& socketId, const nlohmann::json& data) {
+    metrics::ScopedLatency latency(metrics::Stage::Handle, "player_decision");
+    alloc::AllocScope allocScope("player_decision");
     auto roomIt = socketToRoomCode_.find(socketId);
     if (roomIt == socketToRoomCode_.end()) return;
     
@@ -488,6 +823,7 @@ void GameManager::handlePlayerDecision(const std::string& socketId, const nlohma
     
     Game* game = getGame(roomIt->second);
     if (!game || game->state != GameState::PLAYING) return;
+    RoomMutation mutation(*this, game);
     
     if (!data.contains("decision")) return;
     
@@ -498,7 +834,7 @@ void GameManager::handlePlayerDecision(const std::string& socketId, const nlohma
     }
     
     Player* player = game->findPlayerById(playerIdIt->second);
-    if (!player || !player->isActive) return;
+    if (!player || !player->isActive || game->roundResolved) return;
     
     if (game->decisions.find(player->id) != game->decisions.end()) {
         sendMessage_(socketId, "error", {{"message", "Decision already made"}});
@@ -506,20 +842,41 @@ void GameManager::handlePlayerDecision(const std::string& socketId, const nlohma
     }
     
     game->decisions[player->id] = decision;
+    tracing::instant("player_decided", game->roomCode, game->round);
     
-    broadcastToRoom_(game->roomCode, "player_decided", {
+    broadcastEvent(game, "player_decided", {
         {"playerId", player->id},
         {"playerName", player->name}
     });
+    journal(game, "player_decision");
     
     // Check if all active players have decided
-    auto activePlayers = game->getActivePlayers();
-    if (game->decisions.size() == activePlayers.size()) {
+    if (game->allActivePlayersDecided()) {
         resolveRound(game);
     }
 }
 
 void GameManager::resolveRound(Game* game) {
+    // Early resolution and the decision timer can both get here
+    if (game->roundResolved) return;
+    game->roundResolved = true;
+    modified(game);
+    tracing::Span span("resolve_round", game->roomCode, game->round);
+    
+    // Only set once the timer has started (not if everyone left during the deal)
+    auto decisionStart = game->decisionDeadline - std::chrono::seconds(kDecisionSeconds);
+    if (decisionStart >= game->roundStartedAt) {
+        tracing::complete("decision_window", game->roomCode, game->round, decisionStart, tracing::Clock::now());
+    }
+    
+    // Players still away when the round resolves sit it out
+    for (auto& p : game->players) {
+        if (p.awaitingReconnect) {
+            p.awaitingReconnect = false;
+            p.isActive = false;
+        }
+    }
+    
     auto activePlayers = game->getActivePlayers();
     
     // Auto-drop players who didn't decide
@@ -563,14 +920,15 @@ void GameManager::resolveRound(Game* game) {
     }
     
     // Wait 2 seconds for animations
-    std::thread([this, game, decisionsJson, holders, activePlayers]() mutable {
-        std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+    runPhaseAfter(game, "wait_reveal", 2.0, [this, game, roomCode = game->roomCode, decisionsJson, holders]() {
+        if (awakeGame(roomCode) != game) return;
         
         if (holders.empty()) {
             // Everyone dropped - pot carries forward (ante was already collected at round start)
             // No additional deduction needed
+            metrics::increment(metrics::Counter::RoundsAllDropped);
             
-            broadcastToRoom_(game->roomCode, "round_reveal", {
+            broadcastEvent(game, "round_reveal", {
                 {"decisions", decisionsJson},
                 {"pot", game->pot}
             });
@@ -591,36 +949,42 @@ void GameManager::resolveRound(Game* game) {
                 });
             }
             
-            broadcastToRoom_(game->roomCode, "all_dropped", {
+            broadcastEvent(game, "all_dropped", {
                 {"pot", game->pot},
                 {"balances", balancesJson}
             });
+            finishRoundTrace(game);
+            game->roundInFlight = false;
+            journal(game, "round_result");
+            recordHand(game, HandOutcome::AllDropped, game->pot, "");
             
             for (auto* p : playersInDebt) {
-                if (!p->socketId.empty()) {
-                    sendMessage_(p->socketId, "player_in_debt", {
-                        {"debtAmount", std::abs(p->balance)},
-                        {"balance", p->balance}
-                    });
-                }
+                sendPlayerEvent(game, *p, "player_in_debt", {
+                    {"debtAmount", std::abs(p->balance)},
+                    {"balance", p->balance}
+                });
             }
         } else if (holders.size() == 1) {
             // Single holder vs deck
             handleDeckShowdown(game, holders[0]);
         } else {
             // Multiple holders
-            broadcastToRoom_(game->roomCode, "round_reveal", {
+            broadcastEvent(game, "round_reveal", {
                 {"decisions", decisionsJson},
                 {"pot", game->pot}
             });
             
-            std::this_thread::sleep_for(std::chrono::milliseconds(3000));
-            handleMultipleHolders(game, holders);
+            runPhaseAfter(game, "wait_holders_result", 3.0, [this, game, roomCode = game->roomCode, holders]() {
+                if (awakeGame(roomCode) != game) return;
+                handleMultipleHolders(game, holders);
+            });
         }
-    }).detach();
+    });
 }
 
 void GameManager::handleMultipleHolders(Game* game, const std::vector<Player*>& holders) {
+    tracing::Span span("multiple_holders", game->roomCode, game->round);
+    modified(game);
     struct EvaluatedHand {
         Player* player;
         HandEvaluation evaluation;
@@ -665,6 +1029,10 @@ void GameManager::handleMultipleHolders(Game* game, const std::vector<Player*>&
     
     // New pot is the sum of all loser payments
     game->pot = newPotAddition;
+    game->roundInFlight = false;
+    journal(game, "round_result");
+    recordHand(game, HandOutcome::MultipleHolders, currentPot, winner->id);
+    metrics::increment(metrics::Counter::RoundsMultipleHolders);
     
     // Check for debt
     std::vector<Player*> playersInDebt;
@@ -690,7 +1058,7 @@ void GameManager::handleMultipleHolders(Game* game, const std::vector<Player*>&
         });
     }
     
-    broadcastToRoom_(game->roomCode, "multiple_holders_result", {
+    broadcastEvent(game, "multiple_holders_result", {
         {"winner", {
             {"playerId", winner->id},
             {"playerName", winner->name},
@@ -702,18 +1070,18 @@ void GameManager::handleMultipleHolders(Game* game, const std::vector<Player*>&
         {"newPot", game->pot},
         {"balances", balancesJson}
     });
+    finishRoundTrace(game);
     
     for (auto* p : playersInDebt) {
-        if (!p->socketId.empty()) {
-            sendMessage_(p->socketId, "player_in_debt", {
-                {"debtAmount", std::abs(p->balance)},
-                {"balance", p->balance}
-            });
-        }
+        sendPlayerEvent(game, *p, "player_in_debt", {
+            {"debtAmount", std::abs(p->balance)},
+            {"balance", p->balance}
+        });
     }
 }
 
 void GameManager::handleDeckShowdown(Game* game, Player* holder) {
+    tracing::Span span("deck_showdown", game->roomCode, game->round);
     // Deal 3 cards to the deck
     auto deckCards = GameLogic::dealCards(game->deck, 3);
     
@@ -738,7 +1106,7 @@ void GameManager::handleDeckShowdown(Game* game, Player* holder) {
         deckCardsJson.push_back(card.toJson());
     }
     
-    broadcastToRoom_(game->roomCode, "single_holder_vs_deck", {
+    broadcastEvent(game, "single_holder_vs_deck", {
         {"player", {
             {"playerId", holder->id},
             {"playerName", holder->name}
@@ -749,14 +1117,19 @@ void GameManager::handleDeckShowdown(Game* game, Player* holder) {
         {"deckHandType", static_cast<int>(deckEval.type)}
     });
     
-    std::thread([this, game, holder, playerWon]() {
-        std::this_thread::sleep_for(std::chrono::milliseconds(5000));
+    runPhaseAfter(game, "wait_deck_result", 5.0, [this, game, roomCode = game->roomCode, holder, playerWon,
+                                                  deckCards = std::move(deckCards)]() mutable {
+        if (awakeGame(roomCode) != game) return;
+        finishRoundTrace(game);
+        modified(game);
+        double potBefore = game->pot;
         
         if (playerWon) {
             // Player wins - game ends
             holder->balance += game->pot;
+            metrics::increment(metrics::Counter::RoundsDeckWin);
             
-            broadcastToRoom_(game->roomCode, "deck_showdown_result", {
+            broadcastEvent(game, "deck_showdown_result", {
                 {"playerWon", true},
                 {"winner", {
                     {"playerId", holder->id},
@@ -773,8 +1146,9 @@ void GameManager::handleDeckShowdown(Game* game, Player* holder) {
             double matchAmount = game->pot;
             holder->balance -= matchAmount;
             game->pot += matchAmount;
+            metrics::increment(metrics::Counter::RoundsDeckLoss);
             
-            broadcastToRoom_(game->roomCode, "deck_showdown_result", {
+            broadcastEvent(game, "deck_showdown_result", {
                 {"playerWon", false},
                 {"loser", {
                     {"playerId", holder->id},
@@ -788,18 +1162,21 @@ void GameManager::handleDeckShowdown(Game* game, Player* holder) {
             });
             
             if (holder->balance < 0) {
-                if (!holder->socketId.empty()) {
-                    sendMessage_(holder->socketId, "player_in_debt", {
-                        {"debtAmount", std::abs(holder->balance)},
-                        {"balance", holder->balance}
-                    });
-                }
+                sendPlayerEvent(game, *holder, "player_in_debt", {
+                    {"debtAmount", std::abs(holder->balance)},
+                    {"balance", holder->balance}
+                });
             }
         }
-    }).detach();
+        game->roundInFlight = false;
+        journal(game, "round_result");
+        recordHand(game, playerWon ? HandOutcome::DeckWin : HandOutcome::DeckLoss, potBefore,
+                   playerWon ? holder->id : std::string(), std::move(deckCards));
+    });
 }
 
 void GameManager::endGame(Game* game) {
+    modified(game);
     game->state = GameState::ENDED;
     
     // Sort players by balance
@@ -826,14 +1203,28 @@ void GameManager::endGame(Game* game) {
         };
     }
     
-    broadcastToRoom_(game->roomCode, "game_ended", {
+    broadcastEvent(game, "game_ended", {
         {"finalStandings", standingsJson},
         {"winner", winnerJson},
         {"totalRounds", game->round}
     });
+    
+    if (playerStats_) {
+        for (const auto& p : standings) {
+            PlayerStatsUpdate update;
+            update.token = p.token;
+            update.name = p.name;
+            update.finishedGame = true;
+            update.wonGame = p.id == standings[0].id;
+            playerStats_(std::move(update));
+        }
+    }
+    journal(game, "end_game");
 }
 
 void GameManager::handleNextRound(const std::string& socketId, const nlohmann::json& data) {
+    metrics::ScopedLatency latency(metrics::Stage::Handle, "next_round");
+    alloc::AllocScope allocScope("next_round");
     auto roomIt = socketToRoomCode_.find(socketId);
     if (roomIt == socketToRoomCode_.end()) return;
     
@@ -842,6 +1233,8 @@ void GameManager::handleNextRound(const std::string& socketId, const nlohmann::j
     
     Game* game = getGame(roomIt->second);
     if (!game) return;
+    RoomMutation mutation(*this, game);
+    tracing::Span span("next_round", game->roomCode, game->round);
     
     Player* player = game->findPlayerById(playerIdIt->second);
     if (!player || !player->isHost) {
@@ -851,6 +1244,7 @@ void GameManager::handleNextRound(const std::string& socketId, const nlohmann::j
     
     if (game->state == GameState::ENDED) {
         // Reset game to lobby
+        modified(game);
         game->state = GameState::LOBBY;
         game->round = 0;
         game->pot = 0.0;
@@ -860,17 +1254,10 @@ void GameManager::handleNextRound(const std::string& socketId, const nlohmann::j
             p.isActive = true;
         }
         
-        nlohmann::json playersJson = nlohmann::json::array();
-        for (const auto& p : game->players) {
-            playersJson.push_back({
-                {"id", p.id},
-                {"name", p.name},
-                {"isHost", p.isHost},
-                {"balance", p.balance}
-            });
-        }
+        const auto& playersJson = game->publicSnapshot().players;
         
-        broadcastToRoom_(game->roomCode, "game_reset", {{"players", playersJson}});
+        broadcastEvent(game, "game_reset", {{"players", playersJson}});
+        journal(game, "game_reset");
     } else if (game->state == GameState::PLAYING) {
         if (game->pendingGameEnd) {
             game->pendingGameEnd = false;
@@ -886,12 +1273,10 @@ void GameManager::handleNextRound(const std::string& socketId, const nlohmann::j
             
             if (!playersInDebt.empty()) {
                 for (auto* p : playersInDebt) {
-                    if (!p->socketId.empty()) {
-                        sendMessage_(p->socketId, "player_in_debt", {
-                            {"debtAmount", std::abs(p->balance)},
-                            {"balance", p->balance}
-                        });
-                    }
+                    sendPlayerEvent(game, *p, "player_in_debt", {
+                        {"debtAmount", std::abs(p->balance)},
+                        {"balance", p->balance}
+                    });
                 }
                 
                 std::string names;
@@ -914,6 +1299,8 @@ void GameManager::handleNextRound(const std::string& socketId, const nlohmann::j
 }
 
 void GameManager::handleBuyBackIn(const std::string& socketId, const nlohmann::json& data) {
+    metrics::ScopedLatency latency(metrics::Stage::Handle, "buy_back_in");
+    alloc::AllocScope allocScope("buy_back_in");
     auto roomIt = socketToRoomCode_.find(socketId);
     if (roomIt == socketToRoomCode_.end()) {
         sendMessage_(socketId, "error", {{"message", "Player not found"}});
@@ -931,6 +1318,7 @@ void GameManager::handleBuyBackIn(const std::string& socketId, const nlohmann::j
         sendMessage_(socketId, "error", {{"message", "Game not found"}});
         return;
     }
+    RoomMutation mutation(*this, game);
     
     Player* player = game->findPlayerById(playerIdIt->second);
     if (!player) {
@@ -973,6 +1361,7 @@ void GameManager::handleBuyBackIn(const std::string& socketId, const nlohmann::j
         return;
     }
     
+    modified(game);
     player->balance += amount;
     game->lastActivity = std::chrono::system_clock::now();
     
@@ -983,14 +1372,17 @@ void GameManager::handleBuyBackIn(const std::string& socketId, const nlohmann::j
         {"newBalance", player->balance}
     });
     
-    broadcastToRoom_(game->roomCode, "player_balance_updated", {
+    broadcastEvent(game, "player_balance_updated", {
         {"playerId", player->id},
         {"newBalance", player->balance},
         {"buyBackAmount", amount}
     });
+    journal(game, "buy_back_in");
 }
 
 void GameManager::handleLeaveGame(const std::string& socketId) {
+    metrics::ScopedLatency latency(metrics::Stage::Handle, "leave_game");
+    alloc::AllocScope allocScope("leave_game");
     auto roomIt = socketToRoomCode_.find(socketId);
     if (roomIt == socketToRoomCode_.end()) return;
     
@@ -999,6 +1391,7 @@ void GameManager::handleLeaveGame(const std::string& socketId) {
     
     Game* game = getGame(roomIt->second);
     if (!game) return;
+    RoomMutation mutation(*this, game);
     
     Player* player = game->findPlayerById(playerIdIt->second);
     if (player) {
@@ -1013,6 +1406,7 @@ void GameManager::handleLeaveGame(const std::string& socketId) {
             return;
         }
         
+        modified(game);
         if (game->state == GameState::LOBBY) {
             // Remove player from game
             std::string playerId = player->id;
@@ -1029,7 +1423,7 @@ void GameManager::handleLeaveGame(const std::string& socketId) {
                 game->players[0].isHost = true;
             }
             
-            broadcastToRoom_(game->roomCode, "player_left", {
+            broadcastEvent(game, "player_left", {
                 {"playerId", playerId},
                 {"playerName", playerName}
             });
@@ -1037,6 +1431,7 @@ void GameManager::handleLeaveGame(const std::string& socketId) {
             player->isActive = false;
             player->socketId = "";
         }
+        journal(game, "leave_game");
     }
     
     socketToPlayerId_.erase(socketId);
@@ -1044,11 +1439,15 @@ void GameManager::handleLeaveGame(const std::string& socketId) {
     
     // Clean up empty games
     if (game->players.empty()) {
-        games_.erase(game->roomCode);
+        std::string roomCode = game->roomCode;
+        games_.erase(roomCode);
+        journalRemoved(roomCode, "leave_game");
     }
 }
 
 void GameManager::handleEndGame(const std::string& socketId) {
+    metrics::ScopedLatency latency(metrics::Stage::Handle, "end_game");
+    alloc::AllocScope allocScope("end_game");
     auto roomIt = socketToRoomCode_.find(socketId);
     if (roomIt == socketToRoomCode_.end()) {
         sendMessage_(socketId, "error", {{"message", "Player not found"}});
@@ -1066,6 +1465,7 @@ void GameManager::handleEndGame(const std::string& socketId) {
         sendMessage_(socketId, "error", {{"message", "Game not found"}});
         return;
     }
+    RoomMutation mutation(*this, game);
     
     Player* player = game->findPlayerById(playerIdIt->second);
     if (!player) {
@@ -1082,6 +1482,9 @@ void GameManager::handleEndGame(const std::string& socketId) {
 }
 
 void GameManager::handleDisconnect(const std::string& socketId) {
+    metrics::ScopedLatency latency(metrics::Stage::Handle, "disconnect");
+    alloc::AllocScope allocScope("disconnect");
+    if (frozen_) return;
     auto roomIt = socketToRoomCode_.find(socketId);
     if (roomIt == socketToRoomCode_.end()) return;
     
@@ -1090,24 +1493,73 @@ void GameManager::handleDisconnect(const std::string& socketId) {
     
     Game* game = getGame(roomIt->second);
     if (!game) return;
+    RoomMutation mutation(*this, game);
     
     Player* player = game->findPlayerById(playerIdIt->second);
     if (player) {
-        player->isActive = false;
         player->socketId = "";
         
-        // Auto-drop in current round if playing
-        if (game->state == GameState::PLAYING && 
-            game->decisions.find(player->id) == game->decisions.end()) {
-            game->decisions[player->id] = "drop";
+        bool undecidedInRound = game->state == GameState::PLAYING && !game->roundResolved &&
+            player->isActive && game->decisions.find(player->id) == game->decisions.end();
+        
+        if (undecidedInRound && disconnectGrace_.count() > 0) {
+            // Keep the seat until the grace window (capped at the decision
+            // deadline) runs out; the decision timer expires it
+            auto deadline = std::chrono::steady_clock::now() + disconnectGrace_;
+            if (game->decisionDeadline > std::chrono::steady_clock::now()) {
+                deadline = std::min(deadline, game->decisionDeadline);
+            }
+            player->awaitingReconnect = true;
+            player->reconnectDeadline = deadline;
+        } else {
+            modified(game);
+            player->isActive = false;
+            
+            // Auto-drop in current round if playing
+            if (undecidedInRound) {
+                game->decisions[player->id] = "drop";
+            }
         }
+        journal(game, "disconnect");
     }
     
     socketToPlayerId_.erase(socketId);
     socketToRoomCode_.erase(socketId);
+    
+    // Don't let the remaining players wait out the timer for a dead peer
+    if (game->state == GameState::PLAYING && !game->roundResolved &&
+        game->allActivePlayersDecided()) {
+        resolveRound(game);
+    }
+}
+
+void GameManager::expireDisconnectGrace(Game* game) {
+    if (game->state != GameState::PLAYING || game->roundResolved) return;
+    
+    auto now = std::chrono::steady_clock::now();
+    bool expired = false;
+    for (auto& p : game->players) {
+        if (p.awaitingReconnect && p.socketId.empty() && now >= p.reconnectDeadline) {
+            p.awaitingReconnect = false;
+            p.isActive = false;
+            if (game->decisions.find(p.id) == game->decisions.end()) {
+                game->decisions[p.id] = "drop";
+            }
+            expired = true;
+        }
+    }
+    
+    if (!expired) return;
+    modified(game);
+    
+    if (game->allActivePlayersDecided()) {
+        resolveRound(game);
+    }
 }
 
 void GameManager::handlePlayerEmote(const std::string& socketId, const nlohmann::json& data) {
+    metrics::ScopedLatency latency(metrics::Stage::Handle, "player_emote");
+    alloc::AllocScope allocScope("player_emote");
     auto roomIt = socketToRoomCode_.find(socketId);
     if (roomIt == socketToRoomCode_.end()) return;
     
@@ -1129,7 +1581,7 @@ void GameManager::handlePlayerEmote(const std::string& socketId, const nlohmann:
         return; // Invalid emote path
     }
     
-    // Broadcast emote to all players in the room
+    // Broadcast emote to all players in the room (transient, not logged)
     broadcastToRoom_(game->roomCode, "player_emote", {
         {"playerId", player->id},
         {"playerName", player->name},
@@ -1137,7 +1589,36 @@ void GameManager::handlePlayerEmote(const std::string& socketId, const nlohmann:
     });
 }
 
+bool GameManager::handleEvent(const std::string& socketId, const std::string& event, const nlohmann::json& data) {
+    if (frozen_) return true;
+    if (event == "join_room") {
+        handleJoinRoom(socketId, data);
+    } else if (event == "start_game") {
+        handleStartGame(socketId, data);
+    } else if (event == "set_buy_in") {
+        handleSetBuyIn(socketId, data);
+    } else if (event == "player_decision") {
+        handlePlayerDecision(socketId, data);
+    } else if (event == "next_round") {
+        handleNextRound(socketId, data);
+    } else if (event == "leave_game") {
+        handleLeaveGame(socketId);
+    } else if (event == "buy_back_in") {
+        handleBuyBackIn(socketId, data);
+    } else if (event == "end_game") {
+        handleEndGame(socketId);
+    } else if (event == "player_emote") {
+        handlePlayerEmote(socketId, data);
+    } else if (event == "disconnect") {
+        handleDisconnect(socketId);
+    } else {
+        return false;
+    }
+    return true;
+}
+
 void GameManager::cleanupAbandonedGames() {
+    if (frozen_) return;
     auto now = std::chrono::system_clock::now();
     auto timeout = std::chrono::minutes(5);
     
@@ -1149,9 +1630,85 @@ void GameManager::cleanupAbandonedGames() {
         }
     }
     
+    for (auto it = hibernated_.begin(); it != hibernated_.end();) {
+        auto next = std::next(it);
+        if (now - it->second.summary.lastActivity > timeout) {
+            std::cout << "Cleaning up abandoned game: " << it->first << std::endl;
+            toRemove.push_back(it->first);
+            forgetHibernated(it);
+        }
+        it = next;
+    }
+    
     for (const auto& roomCode : toRemove) {
         games_.erase(roomCode);
+        journalRemoved(roomCode, "abandoned");
+    }
+    metrics::increment(metrics::Counter::CleanupEvictions, toRemove.size());
+}
+
+RoomSummary GameManager::summarize(const Game& game) const {
+    RoomSummary summary;
+    summary.roomCode = game.roomCode;
+    summary.state = game.state;
+    summary.round = game.round;
+    summary.players = game.players.size();
+    summary.pot = game.pot;
+    summary.lastActivity = game.lastActivity;
+    summary.pendingTimers = game.pendingTimers;
+    
+    size_t bytes = sizeof(Game) + heapBytes(game.roomCode) + heapBytes(game.hostToken);
+    bytes += game.players.capacity() * sizeof(Player);
+    for (const auto& player : game.players) {
+        if (!player.socketId.empty()) ++summary.connected;
+        bytes += heapBytes(player.id) + heapBytes(player.token) + heapBytes(player.name) + heapBytes(player.socketId);
+    }
+    bytes += heapBytes(game.deck);
+    for (const auto& [playerId, cards] : game.currentHands) {
+        bytes += kMapNodeOverhead + sizeof(std::pair<const std::string, std::vector<Card>>) + heapBytes(playerId) +
+                 heapBytes(cards);
+    }
+    for (const auto& [playerId, decision] : game.decisions) {
+        bytes += kMapNodeOverhead + sizeof(std::pair<const std::string, std::string>) + heapBytes(playerId) +
+                 heapBytes(decision);
+    }
+    for (const auto& [playerId, balance] : game.roundStartBalances) {
+        bytes += kMapNodeOverhead + sizeof(std::pair<const std::string, double>) + heapBytes(playerId);
+    }
+    const RoomSnapshot& snapshot = game.cachedSnapshot();
+    bytes += heapBytes(snapshot.players) + heapBytes(snapshot.state) + heapBytes(snapshot.playersText) +
+             heapBytes(snapshot.serialized);
+    summary.gameBytes = bytes;
+    
+    summary.timerBytes = game.pendingTimers * kPendingTimerBytes;
+    
+    const auto& events = game.eventLog.buffered();
+    size_t eventLog = events.capacity() * sizeof(RoomEvent);
+    for (const auto& event : events) {
+        eventLog += heapBytes(event.event) + heapBytes(event.data) + heapBytes(event.targetPlayerId);
+    }
+    summary.eventLogBytes = eventLog;
+    return summary;
+}
+
+std::vector<RoomSummary> GameManager::summarizeRooms() const {
+    std::vector<RoomSummary> rooms;
+    rooms.reserve(games_.size() + hibernated_.size());
+    for (const auto& [roomCode, game] : games_) {
+        rooms.push_back(summarize(*game));
+    }
+    for (const auto& [roomCode, room] : hibernated_) {
+        rooms.push_back(room.summary);
+    }
+    return rooms;
+}
+
+std::array<size_t, 3> GameManager::countRoomsByState() const {
+    std::array<size_t, 3> counts{};
+    for (const auto& [roomCode, game] : games_) {
+        counts[static_cast<size_t>(game->state)]++;
     }
+    return counts;
 }
 
 } // namespace guts
@@ -0,0 +1,369 @@
+#include "HandHistory.hpp"
+#include "GameCodec.hpp"
+#include "GameLogic.hpp"
+#include "Metrics.hpp"
+#include <zlib.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace guts {
+
+namespace {
+
+constexpr uint8_t kRecordVersion = 1;
+constexpr char kSegmentMagic[4] = {'G', 'H', 'H', '1'};
+constexpr uint32_t kMaxBlockBytes = 64u << 20;
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+int evaluate(const std::vector<Card>& cards, bool isNothingRound) {
+    if (cards.size() != 3) return 0;
+    return static_cast<int>(GameLogic::evaluateHand(cards, isNothingRound).type);
+}
+
+} // namespace
+
+const char* getHandOutcomeName(HandOutcome outcome) {
+    switch (outcome) {
+        case HandOutcome::AllDropped: return "all_dropped";
+        case HandOutcome::MultipleHolders: return "multiple_holders";
+        case HandOutcome::DeckWin: return "deck_win";
+        case HandOutcome::DeckLoss: return "deck_loss";
+    }
+    return "unknown";
+}
+
+void encodeHandRecord(std::string& out, const HandRecord& record) {
+    BinaryWriter writer(out);
+    writer.u8(kRecordVersion);
+    writer.str(record.roomCode);
+    writer.i64(record.round);
+    writer.i64(record.timestampMs);
+    writer.u8(record.isNothingRound);
+    writer.u8(static_cast<uint8_t>(record.outcome));
+    writer.f64(record.ante);
+    writer.f64(record.potBefore);
+    writer.f64(record.potAfter);
+    writer.str(record.winnerId);
+    writeCards(writer, record.deckCards);
+    writer.u8(static_cast<uint8_t>(record.deckHandType));
+
+    writer.u32(static_cast<uint32_t>(record.players.size()));
+    for (const auto& player : record.players) {
+        writer.str(player.id);
+        writer.str(player.name);
+        writeCards(writer, player.cards);
+        writer.u8(player.decision == "hold" ? 1 : player.decision == "drop" ? 2 : 0);
+        writer.f64(player.balanceBefore);
+        writer.f64(player.balanceAfter);
+        writer.u8(static_cast<uint8_t>(player.handType));
+    }
+}
+
+HandRecord decodeHandRecord(const char* data, size_t size) {
+    BinaryReader reader(data, size);
+    if (reader.u8() != kRecordVersion) throw std::runtime_error("Unsupported hand record version");
+
+    HandRecord record;
+    record.roomCode = reader.str();
+    record.round = static_cast<int>(reader.i64());
+    record.timestampMs = reader.i64();
+    record.isNothingRound = reader.u8() != 0;
+    record.outcome = static_cast<HandOutcome>(reader.u8());
+    record.ante = reader.f64();
+    record.potBefore = reader.f64();
+    record.potAfter = reader.f64();
+    record.winnerId = reader.str();
+    record.deckCards = readCards(reader);
+    record.deckHandType = reader.u8();
+
+    uint32_t players = reader.u32();
+    if (players > 64) throw std::runtime_error("Invalid player count");
+    record.players.resize(players);
+    for (auto& player : record.players) {
+        player.id = reader.str();
+        player.name = reader.str();
+        player.cards = readCards(reader);
+        uint8_t decision = reader.u8();
+        player.decision = decision == 1 ? "hold" : decision == 2 ? "drop" : "";
+        player.balanceBefore = reader.f64();
+        player.balanceAfter = reader.f64();
+        player.handType = reader.u8();
+    }
+    return record;
+}
+
+nlohmann::json handRecordToJson(const HandRecord& record) {
+    auto cardsJson = [](const std::vector<Card>& cards) {
+        nlohmann::json array = nlohmann::json::array();
+        for (const auto& card : cards) array.push_back(card.toJson());
+        return array;
+    };
+    auto handName = [](int type) -> nlohmann::json {
+        if (type == 0) return nullptr;
+        return getHandTypeName(static_cast<HandType>(type));
+    };
+
+    nlohmann::json players = nlohmann::json::array();
+    for (const auto& player : record.players) {
+        players.push_back({
+            {"playerId", player.id},
+            {"playerName", player.name},
+            {"cards", cardsJson(player.cards)},
+            {"handType", handName(player.handType)},
+            {"decision", player.decision},
+            {"balanceBefore", player.balanceBefore},
+            {"balanceAfter", player.balanceAfter},
+            {"delta", player.balanceAfter - player.balanceBefore}
+        });
+    }
+
+    return {
+        {"roomCode", record.roomCode},
+        {"round", record.round},
+        {"timestamp", record.timestampMs},
+        {"isNothingRound", record.isNothingRound},
+        {"outcome", getHandOutcomeName(record.outcome)},
+        {"ante", record.ante},
+        {"potBefore", record.potBefore},
+        {"potAfter", record.potAfter},
+        {"winnerId", record.winnerId.empty() ? nlohmann::json(nullptr) : nlohmann::json(record.winnerId)},
+        {"deckCards", cardsJson(record.deckCards)},
+        {"deckHandType", handName(record.deckHandType)},
+        {"players", players}
+    };
+}
+
+bool readHandHistorySegment(const std::string& path, const std::function<void(const HandRecord&)>& visit) {
+    // Mapped rather than read, so a batch over many segments pages the
+    // files in from the cache without copying them
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(kSegmentMagic)) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return false;
+    ::madvise(mapped, size, MADV_SEQUENTIAL);
+
+    struct Unmap {
+        void* address;
+        size_t length;
+        ~Unmap() { ::munmap(address, length); }
+    } unmap{mapped, size};
+
+    const char* data = static_cast<const char*>(mapped);
+    if (std::memcmp(data, kSegmentMagic, sizeof(kSegmentMagic)) != 0) return false;
+
+    size_t offset = sizeof(kSegmentMagic);
+    std::string raw;
+    while (size - offset >= 12) {
+        BinaryReader header(data + offset, 12);
+        uint32_t rawLength = header.u32();
+        uint32_t compressedLength = header.u32();
+        uint32_t checksum = header.u32();
+        if (rawLength > kMaxBlockBytes || size - offset - 12 < compressedLength) break;
+
+        const auto* compressed = reinterpret_cast<const Bytef*>(data + offset + 12);
+        if (crc32(0, compressed, compressedLength) != checksum) break;
+
+        raw.resize(rawLength);
+        uLongf length = rawLength;
+        if (uncompress(reinterpret_cast<Bytef*>(&raw[0]), &length, compressed, compressedLength) != Z_OK ||
+            length != rawLength) {
+            break;
+        }
+
+        BinaryReader records(raw.data(), raw.size());
+        try {
+            while (records.remaining() > 0) {
+                uint32_t recordSize = records.u32();
+                size_t start = records.position();
+                records.skip(recordSize);
+                visit(decodeHandRecord(raw.data() + start, recordSize));
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Hand history: bad record in " << path << ": " << e.what() << std::endl;
+            return true;
+        }
+        offset += 12 + compressedLength;
+    }
+    return true;
+}
+
+HandHistory::HandHistory(Options options) : options_(std::move(options)) {
+    if (::mkdir(options_.directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        throw std::runtime_error("Cannot create hand history directory " + options_.directory +
+                                 ": " + std::strerror(errno));
+    }
+}
+
+HandHistory::~HandHistory() {
+    stop();
+}
+
+void HandHistory::start() {
+    writer_ = std::thread([this]() { run(); });
+}
+
+void HandHistory::stop() {
+    if (stopping_.exchange(true)) return;
+    if (writer_.joinable()) writer_.join();
+}
+
+void HandHistory::record(HandRecord record) {
+    if (queued_.load(std::memory_order_relaxed) >= options_.maxQueued) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    queued_.fetch_add(1, std::memory_order_relaxed);
+    queue_.push(std::move(record));
+}
+
+void HandHistory::run() {
+    while (!stopping_.load(std::memory_order_acquire)) {
+        // Producers never signal, so poll; history can wait a few ms
+        if (!drain()) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        auto now = std::chrono::steady_clock::now();
+        if (blockRecords_ > 0 &&
+            std::chrono::duration<double>(now - blockStarted_).count() >= options_.flushSeconds) {
+            flushBlock();
+        }
+    }
+
+    drain();
+    flushBlock();
+    closeSegment();
+}
+
+bool HandHistory::drain() {
+    HandRecord record;
+    bool any = false;
+    while (queue_.pop(record)) {
+        any = true;
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+
+        // Hands are evaluated here rather than on the event loop
+        for (auto& player : record.players) {
+            player.handType = evaluate(player.cards, record.isNothingRound);
+        }
+        record.deckHandType = evaluate(record.deckCards, record.isNothingRound);
+
+        if (blockRecords_ == 0) blockStarted_ = std::chrono::steady_clock::now();
+        size_t lengthAt = block_.size();
+        block_.append(4, '\0');
+        encodeHandRecord(block_, record);
+        uint32_t length = static_cast<uint32_t>(block_.size() - lengthAt - 4);
+        for (int i = 0; i < 4; ++i) block_[lengthAt + i] = static_cast<char>(length >> (8 * i));
+        ++blockRecords_;
+        records_.fetch_add(1, std::memory_order_relaxed);
+
+        if (block_.size() >= options_.blockBytes) flushBlock();
+    }
+    return any;
+}
+
+void HandHistory::flushBlock() {
+    if (blockRecords_ == 0) return;
+
+    uLongf compressedLength = compressBound(static_cast<uLong>(block_.size()));
+    std::string frame(12 + compressedLength, '\0');
+    int rc = compress2(reinterpret_cast<Bytef*>(&frame[12]), &compressedLength,
+                       reinterpret_cast<const Bytef*>(block_.data()), static_cast<uLong>(block_.size()),
+                       Z_DEFAULT_COMPRESSION);
+    if (rc == Z_OK) {
+        frame.resize(12 + compressedLength);
+        std::string header;
+        BinaryWriter writer(header);
+        writer.u32(static_cast<uint32_t>(block_.size()));
+        writer.u32(static_cast<uint32_t>(compressedLength));
+        writer.u32(static_cast<uint32_t>(crc32(0, reinterpret_cast<const Bytef*>(&frame[12]),
+                                               static_cast<uInt>(compressedLength))));
+        frame.replace(0, 12, header);
+
+        auto now = std::chrono::steady_clock::now();
+        if (segmentFd_ >= 0 && (segmentBytes_ >= options_.segmentBytes ||
+                                std::chrono::duration<double>(now - segmentOpened_).count() >= options_.segmentSeconds)) {
+            closeSegment();
+        }
+        if (segmentFd_ < 0) openSegment();
+
+        if (segmentFd_ >= 0 && writeAll(segmentFd_, frame.data(), frame.size())) {
+            ::fdatasync(segmentFd_);
+            segmentBytes_ += frame.size();
+            rawBytes_.fetch_add(block_.size(), std::memory_order_relaxed);
+            compressedBytes_.fetch_add(frame.size(), std::memory_order_relaxed);
+        } else {
+            errors_.fetch_add(1, std::memory_order_relaxed);
+            std::cerr << "Hand history: write failed: " << std::strerror(errno) << std::endl;
+        }
+    } else {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+        std::cerr << "Hand history: compression failed (" << rc << ")" << std::endl;
+    }
+
+    block_.clear();
+    blockRecords_ = 0;
+}
+
+void HandHistory::openSegment() {
+    auto epochMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::string path = options_.directory + "/hands-" + std::to_string(epochMs) + "-" +
+                       std::to_string(segmentIndex_++) + ".ghh";
+
+    segmentFd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (segmentFd_ < 0 || !writeAll(segmentFd_, kSegmentMagic, sizeof(kSegmentMagic))) {
+        std::cerr << "Hand history: cannot open " << path << ": " << std::strerror(errno) << std::endl;
+        if (segmentFd_ >= 0) ::close(segmentFd_);
+        segmentFd_ = -1;
+        return;
+    }
+    segmentBytes_ = sizeof(kSegmentMagic);
+    segmentOpened_ = std::chrono::steady_clock::now();
+}
+
+void HandHistory::closeSegment() {
+    if (segmentFd_ < 0) return;
+    ::fdatasync(segmentFd_);
+    ::close(segmentFd_);
+    segmentFd_ = -1;
+}
+
+void HandHistory::renderPrometheus(std::string& out) const {
+    metrics::appendMetricHeader(out, "guts_hand_history_records_total", "Rounds written to the hand history", "counter");
+    metrics::appendSample(out, "guts_hand_history_records_total", "", static_cast<double>(records_.load(std::memory_order_relaxed)));
+    metrics::appendMetricHeader(out, "guts_hand_history_dropped_total", "Rounds dropped because the writer fell behind", "counter");
+    metrics::appendSample(out, "guts_hand_history_dropped_total", "", static_cast<double>(dropped_.load(std::memory_order_relaxed)));
+    metrics::appendMetricHeader(out, "guts_hand_history_raw_bytes_total", "Encoded hand history bytes before compression", "counter");
+    metrics::appendSample(out, "guts_hand_history_raw_bytes_total", "", static_cast<double>(rawBytes_.load(std::memory_order_relaxed)));
+    metrics::appendMetricHeader(out, "guts_hand_history_bytes_total", "Compressed hand history bytes written", "counter");
+    metrics::appendSample(out, "guts_hand_history_bytes_total", "", static_cast<double>(compressedBytes_.load(std::memory_order_relaxed)));
+    metrics::appendMetricHeader(out, "guts_hand_history_errors_total", "Failed hand history writes", "counter");
+    metrics::appendSample(out, "guts_hand_history_errors_total", "", static_cast<double>(errors_.load(std::memory_order_relaxed)));
+    metrics::appendMetricHeader(out, "guts_hand_history_queue_depth", "Rounds waiting for the hand history writer", "gauge");
+    metrics::appendSample(out, "guts_hand_history_queue_depth", "", static_cast<double>(queued_.load(std::memory_order_relaxed)));
+}
+
+} // namespace guts
@@ -0,0 +1,218 @@
+#include "Handoff.hpp"
+#include "GameCodec.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace guts {
+
+namespace {
+
+constexpr char kRequest[4] = {'G', 'H', 'O', '1'};
+constexpr char kConfirm = 'R';
+constexpr uint64_t kMaxPayloadBytes = 4ull << 30;
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool readAll(int fd, char* data, size_t size) {
+    while (size > 0) {
+        ssize_t got = ::recv(fd, data, size, 0);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        data += got;
+        size -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+sockaddr_un socketAddress(const std::string& path) {
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Handoff socket path too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+// Only a process of the same user may take the rooms (and their tokens)
+bool sameUser(int fd) {
+    ucred peer {};
+    socklen_t size = sizeof(peer);
+    if (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &peer, &size) != 0) return false;
+    return peer.uid == ::getuid();
+}
+
+} // namespace
+
+HandoffListener::HandoffListener(std::string path, std::function<std::vector<RoomImage>()> exportRooms,
+                                 std::function<void()> handedOff, double confirmSeconds)
+    : path_(std::move(path)), exportRooms_(std::move(exportRooms)),
+      handedOff_(std::move(handedOff)), confirmSeconds_(confirmSeconds) {
+}
+
+HandoffListener::~HandoffListener() {
+    stop();
+}
+
+void HandoffListener::start() {
+    sockaddr_un address = socketAddress(path_);
+    listenFd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0) {
+        throw std::runtime_error(std::string("Cannot create handoff socket: ") + std::strerror(errno));
+    }
+
+    // A previous process either handed off (and no longer listens) or died
+    ::unlink(path_.c_str());
+    // Owner-only before listen(), so nobody else can connect in between
+    if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::chmod(path_.c_str(), S_IRUSR | S_IWUSR) != 0 ||
+        ::listen(listenFd_, 1) != 0) {
+        std::string error = std::strerror(errno);
+        ::close(listenFd_);
+        listenFd_ = -1;
+        throw std::runtime_error("Cannot listen on handoff socket " + path_ + ": " + error);
+    }
+    thread_ = std::thread([this]() { run(); });
+}
+
+void HandoffListener::stop() {
+    if (stopping_.exchange(true)) return;
+    if (listenFd_ >= 0) ::shutdown(listenFd_, SHUT_RDWR);
+    if (thread_.joinable()) thread_.join();
+    if (listenFd_ >= 0) ::close(listenFd_);
+    listenFd_ = -1;
+}
+
+void HandoffListener::run() {
+    while (!stopping_.load(std::memory_order_acquire)) {
+        // Poll so stop() is noticed even where shutdown() doesn't wake accept()
+        pollfd waiting {listenFd_, POLLIN, 0};
+        if (::poll(&waiting, 1, 500) <= 0) continue;
+
+        int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) continue;
+        if (!sameUser(fd)) {
+            std::cerr << "Handoff: refused a connection from another user" << std::endl;
+            ::close(fd);
+            continue;
+        }
+
+        char request[sizeof(kRequest)];
+        timeval timeout {5, 0};
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        if (!readAll(fd, request, sizeof(request)) || std::memcmp(request, kRequest, sizeof(kRequest)) != 0) {
+            ::close(fd);
+            continue;
+        }
+
+        // One handoff per process: whatever happens next, this one exits
+        serve(fd);
+        ::close(fd);
+        return;
+    }
+}
+
+void HandoffListener::serve(int fd) {
+    auto started = std::chrono::steady_clock::now();
+    std::vector<RoomImage> rooms = exportRooms_();
+
+    std::string payload;
+    BinaryWriter out(payload);
+    out.u32(static_cast<uint32_t>(rooms.size()));
+    for (const auto& [roomCode, blob] : rooms) {
+        out.str(roomCode);
+        out.str(blob);
+    }
+    std::string header;
+    BinaryWriter(header).u64(payload.size());
+
+    bool sent = writeAll(fd, header.data(), header.size()) && writeAll(fd, payload.data(), payload.size());
+    std::cout << "Handoff: sent " << rooms.size() << " rooms (" << payload.size() << " bytes) in "
+              << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count()
+              << "ms" << std::endl;
+
+    // Keep serving connections until the new process is accepting them
+    char confirm = 0;
+    pollfd waiting {fd, POLLIN, 0};
+    bool confirmed = sent && ::poll(&waiting, 1, static_cast<int>(confirmSeconds_ * 1000)) > 0 &&
+                     ::recv(fd, &confirm, 1, 0) == 1 && confirm == kConfirm;
+    if (!confirmed) {
+        std::cerr << "Handoff: no confirmation from the new process, exiting anyway" << std::endl;
+    }
+    handedOff_();
+}
+
+HandoffClient::~HandoffClient() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+bool HandoffClient::pull(const std::string& path, std::vector<RoomImage>& rooms) {
+    sockaddr_un address = socketAddress(path);
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) return false;
+    if (::connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    timeval timeout {60, 0};
+    ::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    char header[8];
+    if (!writeAll(fd_, kRequest, sizeof(kRequest)) || !readAll(fd_, header, sizeof(header))) {
+        std::cerr << "Handoff: no snapshot from " << path << std::endl;
+        return false;
+    }
+    uint64_t length = BinaryReader(header, sizeof(header)).u64();
+    if (length > kMaxPayloadBytes) return false;
+
+    std::string payload(length, '\0');
+    if (!readAll(fd_, &payload[0], payload.size())) {
+        std::cerr << "Handoff: snapshot from " << path << " cut short" << std::endl;
+        return false;
+    }
+
+    try {
+        BinaryReader in(payload.data(), payload.size());
+        uint32_t count = in.u32();
+        rooms.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            std::string roomCode = in.str();
+            rooms.emplace_back(std::move(roomCode), in.str());
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Handoff: bad snapshot: " << e.what() << std::endl;
+        rooms.clear();
+        return false;
+    }
+    return true;
+}
+
+void HandoffClient::confirm() {
+    if (fd_ < 0) return;
+    writeAll(fd_, &kConfirm, 1);
+    ::close(fd_);
+    fd_ = -1;
+}
+
+} // namespace guts
@@ -0,0 +1,115 @@
+#include "LoopMonitor.hpp"
+#include "Metrics.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace guts {
+
+namespace {
+
+// Probes in a row above (or below) the threshold before the state flips,
+// so a single GC-like hiccup doesn't flap the warning
+constexpr int kSaturationProbes = 3;
+
+} // namespace
+
+LoopMonitor::LoopMonitor(size_t loopCount, double probeIntervalSeconds, double saturationLagMs)
+    : probeInterval_(probeIntervalSeconds > 0 ? probeIntervalSeconds : 0.1),
+      saturationLagNanos_(static_cast<uint64_t>(saturationLagMs * 1e6)),
+      schedules_(loopCount) {
+    loops_.reserve(loopCount);
+    for (size_t i = 0; i < loopCount; ++i) {
+        loops_.push_back(std::make_unique<LoopState>());
+    }
+}
+
+void LoopMonitor::attach(size_t index, ScheduleFn schedule) {
+    if (index >= loops_.size()) return;
+    schedules_[index] = std::move(schedule);
+
+    auto due = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(probeInterval_));
+    schedules_[index](probeInterval_, [this, index, due]() { probe(index, due); });
+}
+
+void LoopMonitor::probe(size_t index, std::chrono::steady_clock::time_point due) {
+    auto now = std::chrono::steady_clock::now();
+    uint64_t lag = now > due ?
+        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - due).count()) : 0;
+
+    metrics::recordLoopLag(lag);
+    observe(index, lag);
+
+    auto next = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(probeInterval_));
+    schedules_[index](probeInterval_, [this, index, next]() { probe(index, next); });
+}
+
+void LoopMonitor::observe(size_t index, uint64_t lagNanos) {
+    LoopState& state = *loops_[index];
+
+    // EWMA with alpha = 1/8
+    uint64_t smoothed = state.smoothedLagNanos.load(std::memory_order_relaxed);
+    smoothed = smoothed - smoothed / 8 + lagNanos / 8;
+    state.smoothedLagNanos.store(smoothed, std::memory_order_relaxed);
+
+    if (saturationLagNanos_ == 0) return;
+
+    bool over = lagNanos >= saturationLagNanos_;
+    bool wasSaturated = state.saturated.load(std::memory_order_relaxed);
+
+    if (over == wasSaturated) {
+        state.overThreshold = 0;
+        return;
+    }
+    if (++state.overThreshold < kSaturationProbes) return;
+
+    state.overThreshold = 0;
+    state.saturated.store(over, std::memory_order_relaxed);
+    if (over) {
+        std::cerr << "Event loop " << index << " saturated: timers running "
+                  << lagNanos / 1000000 << "ms late" << std::endl;
+    } else {
+        std::cout << "Event loop " << index << " recovered" << std::endl;
+    }
+}
+
+double LoopMonitor::lagMs(size_t index) const {
+    if (index >= loops_.size()) return 0.0;
+    return static_cast<double>(loops_[index]->smoothedLagNanos.load(std::memory_order_relaxed)) / 1e6;
+}
+
+double LoopMonitor::maxLagMs() const {
+    double worst = 0.0;
+    for (size_t i = 0; i < loops_.size(); ++i) {
+        worst = std::max(worst, lagMs(i));
+    }
+    return worst;
+}
+
+bool LoopMonitor::saturated(size_t index) const {
+    return index < loops_.size() && loops_[index]->saturated.load(std::memory_order_relaxed);
+}
+
+bool LoopMonitor::anySaturated() const {
+    for (size_t i = 0; i < loops_.size(); ++i) {
+        if (saturated(i)) return true;
+    }
+    return false;
+}
+
+void LoopMonitor::renderPrometheus(std::string& out) const {
+    metrics::appendMetricHeader(out, "guts_loop_lag_ewma_seconds", "Smoothed event loop lag", "gauge");
+    for (size_t i = 0; i < loops_.size(); ++i) {
+        metrics::appendSample(out, "guts_loop_lag_ewma_seconds",
+            "loop=\"" + std::to_string(i) + "\"", lagMs(i) / 1000.0);
+    }
+
+    metrics::appendMetricHeader(out, "guts_loop_saturated", "1 while the loop's lag stays above the threshold", "gauge");
+    for (size_t i = 0; i < loops_.size(); ++i) {
+        metrics::appendSample(out, "guts_loop_saturated",
+            "loop=\"" + std::to_string(i) + "\"", saturated(i) ? 1.0 : 0.0);
+    }
+}
+
+} // namespace guts
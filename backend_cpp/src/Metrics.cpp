@@ -0,0 +1,332 @@
+#include "Metrics.hpp"
+#include "LatencyHistogram.hpp"
+#include <array>
+#include <map>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+#include <cstdio>
+
+namespace guts {
+namespace metrics {
+
+namespace {
+
+// Known wire events in both directions; anything else is "other"
+const std::array<const char*, 35> EVENT_NAMES = {
+    // Inbound
+    "join_room", "start_game", "set_buy_in", "player_decision", "next_round",
+    "leave_game", "buy_back_in", "end_game", "player_emote",
+    // Outbound
+    "error", "room_joined", "join_throttled", "player_joined", "player_left",
+    "buy_in_updated", "game_started", "round_started", "cards_dealt",
+    "timer_started", "timer_tick", "player_decided", "round_reveal",
+    "all_dropped", "multiple_holders_result", "single_holder_vs_deck",
+    "deck_showdown_result", "player_in_debt", "round_blocked_debt",
+    "buy_back_result", "player_balance_updated", "game_ended", "game_reset",
+    // Internal
+    "disconnect", "invalid", "other"
+};
+
+constexpr size_t kEventCount = EVENT_NAMES.size();
+constexpr size_t kOtherEvent = kEventCount - 1;
+constexpr size_t kCounterCount = static_cast<size_t>(Counter::Count);
+constexpr size_t kGaugeCount = static_cast<size_t>(Gauge::Count);
+constexpr size_t kStageCount = static_cast<size_t>(Stage::Count);
+constexpr size_t kLatencyKeys = kStageCount * kEventCount;
+
+const std::array<const char*, kStageCount> STAGE_NAMES = {"handle", "send", "parse"};
+
+size_t eventIndex(const std::string& event) {
+    static const std::unordered_map<std::string, size_t> index = [] {
+        std::unordered_map<std::string, size_t> map;
+        for (size_t i = 0; i < kEventCount; ++i) {
+            map.emplace(EVENT_NAMES[i], i);
+        }
+        return map;
+    }();
+
+    auto it = index.find(event);
+    return it != index.end() ? it->second : kOtherEvent;
+}
+
+struct ThreadSlot {
+    std::array<std::atomic<uint64_t>, kCounterCount> counters{};
+    std::array<std::atomic<int64_t>, kGaugeCount> gauges{};
+    std::array<std::atomic<uint64_t>, kEventCount> messagesIn{};
+    std::array<std::atomic<uint64_t>, kEventCount> messagesOut{};
+    
+    // Allocated on first use; the owner publishes the pointer, mergers read it
+    std::array<std::atomic<LatencyHistogram*>, kLatencyKeys> latencies{};
+    std::atomic<LatencyHistogram*> loopLag{nullptr};
+    std::atomic<LatencyHistogram*> timerDrift{nullptr};
+    std::vector<std::unique_ptr<LatencyHistogram>> ownedLatencies;
+    
+    std::atomic<int64_t> loopIndex{-1}; // IO loop served by this thread, if any
+};
+
+// Slots are never freed so counts from exited threads are kept
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadSlot>> registry;
+
+ThreadSlot& localSlot() {
+    thread_local ThreadSlot* slot = [] {
+        auto owned = std::make_unique<ThreadSlot>();
+        ThreadSlot* raw = owned.get();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.push_back(std::move(owned));
+        return raw;
+    }();
+    return *slot;
+}
+
+// Only the owning thread writes its slot, so no read-modify-write is needed
+template <typename T, typename D>
+inline void bump(std::atomic<T>& value, D delta) {
+    value.store(value.load(std::memory_order_relaxed) + static_cast<T>(delta),
+                std::memory_order_relaxed);
+}
+
+template <typename T, size_t N>
+std::array<T, N> sumSlots(std::array<std::atomic<T>, N> ThreadSlot::*member) {
+    std::array<T, N> total{};
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& slot : registry) {
+        for (size_t i = 0; i < N; ++i) {
+            total[i] += ((*slot).*member)[i].load(std::memory_order_relaxed);
+        }
+    }
+    return total;
+}
+
+LatencyHistogram& histogramIn(ThreadSlot& slot, std::atomic<LatencyHistogram*>& pointer) {
+    LatencyHistogram* histogram = pointer.load(std::memory_order_relaxed);
+    if (!histogram) {
+        slot.ownedLatencies.push_back(std::make_unique<LatencyHistogram>());
+        histogram = slot.ownedLatencies.back().get();
+        pointer.store(histogram, std::memory_order_release);
+    }
+    return *histogram;
+}
+
+void mergeInto(std::unique_ptr<LatencyHistogram>& target, const std::atomic<LatencyHistogram*>& source) {
+    LatencyHistogram* histogram = source.load(std::memory_order_acquire);
+    if (!histogram) return;
+    if (!target) target = std::make_unique<LatencyHistogram>();
+    target->mergeFrom(*histogram);
+}
+
+// Published latency state, rebuilt by mergeLatencies()
+struct PublishedLatency {
+    LatencyHistogram cumulative; // everything recorded so far
+    LatencyHistogram window;     // recorded since the previous merge
+};
+
+void publish(std::unique_ptr<PublishedLatency>& published, const LatencyHistogram& merged) {
+    if (!published) published = std::make_unique<PublishedLatency>();
+    published->window = merged;
+    published->window.subtract(published->cumulative);
+    published->cumulative = merged;
+}
+
+// Quantiles cover the last merge window, _sum/_count are cumulative
+void appendSummary(std::string& out, const char* name, const std::string& labels,
+                   const PublishedLatency& published) {
+    std::string sumName = std::string(name) + "_sum";
+    std::string countName = std::string(name) + "_count";
+    std::string prefix = labels.empty() ? "" : labels + ",";
+
+    for (double q : {0.5, 0.99, 0.999}) {
+        char quantile[32];
+        snprintf(quantile, sizeof(quantile), "quantile=\"%g\"", q);
+        appendSample(out, name, prefix + quantile,
+            static_cast<double>(published.window.valueAtQuantile(q)) / 1e9);
+    }
+    appendSample(out, sumName.c_str(), labels, static_cast<double>(published.cumulative.sum()) / 1e9);
+    appendSample(out, countName.c_str(), labels, static_cast<double>(published.cumulative.count()));
+}
+
+std::mutex latencyMutex;
+std::map<size_t, std::unique_ptr<PublishedLatency>> publishedLatencies;
+std::map<int64_t, std::unique_ptr<PublishedLatency>> publishedLoopLag;
+std::unique_ptr<PublishedLatency> publishedTimerDrift;
+
+} // namespace
+
+size_t eventId(const std::string& event) {
+    return eventIndex(event);
+}
+
+void recordLatency(Stage stage, size_t eventId, uint64_t nanos) {
+    ThreadSlot& slot = localSlot();
+    size_t key = static_cast<size_t>(stage) * kEventCount + (eventId < kEventCount ? eventId : kOtherEvent);
+    histogramIn(slot, slot.latencies[key]).record(nanos);
+}
+
+void setThreadLoop(size_t loopIndex) {
+    localSlot().loopIndex.store(static_cast<int64_t>(loopIndex), std::memory_order_relaxed);
+}
+
+void recordLoopLag(uint64_t nanos) {
+    ThreadSlot& slot = localSlot();
+    histogramIn(slot, slot.loopLag).record(nanos);
+}
+
+void recordTimerDrift(uint64_t nanos) {
+    ThreadSlot& slot = localSlot();
+    histogramIn(slot, slot.timerDrift).record(nanos);
+}
+
+void mergeLatencies() {
+    std::vector<std::unique_ptr<LatencyHistogram>> merged(kLatencyKeys);
+    std::map<int64_t, std::unique_ptr<LatencyHistogram>> mergedLoopLag;
+    std::unique_ptr<LatencyHistogram> mergedTimerDrift;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto& slot : registry) {
+            for (size_t key = 0; key < kLatencyKeys; ++key) {
+                mergeInto(merged[key], slot->latencies[key]);
+            }
+            
+            int64_t loop = slot->loopIndex.load(std::memory_order_relaxed);
+            if (loop >= 0) mergeInto(mergedLoopLag[loop], slot->loopLag);
+            mergeInto(mergedTimerDrift, slot->timerDrift);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(latencyMutex);
+    for (size_t key = 0; key < kLatencyKeys; ++key) {
+        if (merged[key]) publish(publishedLatencies[key], *merged[key]);
+    }
+    for (const auto& [loop, histogram] : mergedLoopLag) {
+        if (histogram) publish(publishedLoopLag[loop], *histogram);
+    }
+    if (mergedTimerDrift) publish(publishedTimerDrift, *mergedTimerDrift);
+}
+
+void increment(Counter counter, uint64_t amount) {
+    bump(localSlot().counters[static_cast<size_t>(counter)], amount);
+}
+
+void adjust(Gauge gauge, int64_t delta) {
+    bump(localSlot().gauges[static_cast<size_t>(gauge)], delta);
+}
+
+void recordMessageIn(const std::string& event, size_t bytes) {
+    ThreadSlot& slot = localSlot();
+    bump(slot.messagesIn[eventIndex(event)], 1);
+    bump(slot.counters[static_cast<size_t>(Counter::WsBytesIn)], bytes);
+}
+
+void recordMessageOut(const std::string& event, size_t bytes, size_t recipients) {
+    ThreadSlot& slot = localSlot();
+    bump(slot.messagesOut[eventIndex(event)], recipients);
+    bump(slot.counters[static_cast<size_t>(Counter::WsBytesOut)], bytes * recipients);
+}
+
+void appendMetricHeader(std::string& out, const char* name, const char* help, const char* type) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+void appendSample(std::string& out, const char* name, const std::string& labels, double value) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.17g", value);
+    out += name;
+    if (!labels.empty()) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    out += buf;
+    out += '\n';
+}
+
+void renderPrometheus(std::string& out) {
+    auto counters = sumSlots(&ThreadSlot::counters);
+    auto gauges = sumSlots(&ThreadSlot::gauges);
+    auto messagesIn = sumSlots(&ThreadSlot::messagesIn);
+    auto messagesOut = sumSlots(&ThreadSlot::messagesOut);
+
+    auto counter = [&counters](Counter c) {
+        return static_cast<double>(counters[static_cast<size_t>(c)]);
+    };
+
+    appendMetricHeader(out, "guts_ws_connected_sockets", "Currently open WebSocket connections", "gauge");
+    appendSample(out, "guts_ws_connected_sockets", "",
+        static_cast<double>(gauges[static_cast<size_t>(Gauge::ConnectedSockets)]));
+
+    appendMetricHeader(out, "guts_ws_connections_total", "WebSocket connections accepted", "counter");
+    appendSample(out, "guts_ws_connections_total", "", counter(Counter::WsConnectionsOpened));
+
+    appendMetricHeader(out, "guts_ws_messages_in_total", "Inbound WebSocket messages by event", "counter");
+    for (size_t i = 0; i < kEventCount; ++i) {
+        if (messagesIn[i] == 0) continue;
+        appendSample(out, "guts_ws_messages_in_total",
+            std::string("event=\"") + EVENT_NAMES[i] + "\"", static_cast<double>(messagesIn[i]));
+    }
+
+    appendMetricHeader(out, "guts_ws_messages_out_total", "Outbound WebSocket messages by event", "counter");
+    for (size_t i = 0; i < kEventCount; ++i) {
+        if (messagesOut[i] == 0) continue;
+        appendSample(out, "guts_ws_messages_out_total",
+            std::string("event=\"") + EVENT_NAMES[i] + "\"", static_cast<double>(messagesOut[i]));
+    }
+
+    appendMetricHeader(out, "guts_ws_bytes_in_total", "Inbound WebSocket payload bytes", "counter");
+    appendSample(out, "guts_ws_bytes_in_total", "", counter(Counter::WsBytesIn));
+
+    appendMetricHeader(out, "guts_ws_bytes_out_total", "Outbound WebSocket payload bytes", "counter");
+    appendSample(out, "guts_ws_bytes_out_total", "", counter(Counter::WsBytesOut));
+
+    appendMetricHeader(out, "guts_rounds_resolved_total", "Rounds resolved by outcome", "counter");
+    appendSample(out, "guts_rounds_resolved_total", "outcome=\"all_dropped\"", counter(Counter::RoundsAllDropped));
+    appendSample(out, "guts_rounds_resolved_total", "outcome=\"multiple_holders\"", counter(Counter::RoundsMultipleHolders));
+    appendSample(out, "guts_rounds_resolved_total", "outcome=\"deck_win\"", counter(Counter::RoundsDeckWin));
+    appendSample(out, "guts_rounds_resolved_total", "outcome=\"deck_loss\"", counter(Counter::RoundsDeckLoss));
+
+    appendMetricHeader(out, "guts_cleanup_evictions_total", "Abandoned rooms evicted by cleanup", "counter");
+    appendSample(out, "guts_cleanup_evictions_total", "", counter(Counter::CleanupEvictions));
+
+    appendMetricHeader(out, "guts_rooms_hibernated", "Idle rooms held as encoded blobs", "gauge");
+    appendSample(out, "guts_rooms_hibernated", "",
+        static_cast<double>(gauges[static_cast<size_t>(Gauge::HibernatedRooms)]));
+    appendMetricHeader(out, "guts_rooms_hibernated_bytes", "Size of the hibernated room blobs", "gauge");
+    appendSample(out, "guts_rooms_hibernated_bytes", "",
+        static_cast<double>(gauges[static_cast<size_t>(Gauge::HibernatedBytes)]));
+    appendMetricHeader(out, "guts_rooms_hibernations_total", "Idle rooms put into hibernation", "counter");
+    appendSample(out, "guts_rooms_hibernations_total", "", counter(Counter::RoomsHibernated));
+    appendMetricHeader(out, "guts_rooms_woken_total", "Hibernated rooms rehydrated on access", "counter");
+    appendSample(out, "guts_rooms_woken_total", "", counter(Counter::RoomsWoken));
+
+    std::lock_guard<std::mutex> lock(latencyMutex);
+    appendMetricHeader(out, "guts_latency_seconds", "Hot path latency by stage and event", "summary");
+    for (const auto& [key, published] : publishedLatencies) {
+        appendSummary(out, "guts_latency_seconds",
+            std::string("stage=\"") + STAGE_NAMES[key / kEventCount] +
+            "\",event=\"" + EVENT_NAMES[key % kEventCount] + "\"", *published);
+    }
+
+    appendMetricHeader(out, "guts_loop_lag_seconds", "How late probe timers fire on each IO loop", "summary");
+    for (const auto& [loop, published] : publishedLoopLag) {
+        appendSummary(out, "guts_loop_lag_seconds", "loop=\"" + std::to_string(loop) + "\"", *published);
+    }
+
+    appendMetricHeader(out, "guts_timer_drift_seconds", "Decision timer ticks behind their deadline schedule", "summary");
+    if (publishedTimerDrift) {
+        appendSummary(out, "guts_timer_drift_seconds", "", *publishedTimerDrift);
+    }
+}
+
+} // namespace metrics
+} // namespace guts
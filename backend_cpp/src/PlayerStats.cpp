@@ -0,0 +1,272 @@
+#include "PlayerStats.hpp"
+#include "GameCodec.hpp"
+#include "Metrics.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace guts {
+
+namespace {
+
+constexpr char kStatsMagic[4] = {'G', 'P', 'S', '1'};
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+} // namespace
+
+void TopK::update(const std::string* key, double score) {
+    // Scores only grow, so a listed player's new score beats the last entry
+    if (entries_.size() == capacity_ && (capacity_ == 0 || score <= entries_.back().first)) return;
+
+    auto it = std::find_if(entries_.begin(), entries_.end(),
+                           [key](const auto& entry) { return entry.second == key; });
+    if (it != entries_.end()) {
+        it->first = score;
+    } else if (entries_.size() < capacity_) {
+        entries_.emplace_back(score, key);
+        it = entries_.end() - 1;
+    } else {
+        entries_.back() = {score, key};
+        it = entries_.end() - 1;
+    }
+
+    // Ties keep whoever got there first ahead
+    while (it != entries_.begin() && (it - 1)->first < it->first) {
+        std::iter_swap(it - 1, it);
+        --it;
+    }
+}
+
+PlayerStats::PlayerStats(Options options)
+    : options_(std::move(options)), gamesWon_(options_.leaderboardSize), deckWins_(options_.leaderboardSize) {
+}
+
+PlayerStats::~PlayerStats() {
+    stop();
+}
+
+void PlayerStats::start() {
+    load();
+    publish();
+    lastSave_ = std::chrono::steady_clock::now();
+    aggregator_ = std::thread([this]() { run(); });
+}
+
+void PlayerStats::stop() {
+    if (stopping_.exchange(true)) return;
+    if (aggregator_.joinable()) aggregator_.join();
+}
+
+void PlayerStats::record(PlayerStatsUpdate update) {
+    if (queued_.load(std::memory_order_relaxed) >= options_.maxQueued) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    queued_.fetch_add(1, std::memory_order_relaxed);
+    queue_.push(std::move(update));
+}
+
+std::shared_ptr<const std::string> PlayerStats::leaderboard() const {
+    std::lock_guard<std::mutex> lock(leaderboardMutex_);
+    return leaderboard_;
+}
+
+void PlayerStats::run() {
+    while (!stopping_.load(std::memory_order_acquire)) {
+        // Producers never signal, so poll; the leaderboard can lag a little
+        if (!drain()) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        auto now = std::chrono::steady_clock::now();
+        if (changed_ && std::chrono::duration<double>(now - lastPublish_).count() >= options_.publishSeconds) {
+            publish();
+        }
+        if (unsaved_ && std::chrono::duration<double>(now - lastSave_).count() >= options_.saveSeconds) {
+            save();
+        }
+    }
+
+    drain();
+    if (changed_) publish();
+    if (unsaved_) save();
+}
+
+bool PlayerStats::drain() {
+    PlayerStatsUpdate update;
+    bool any = false;
+    while (queue_.pop(update)) {
+        any = true;
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        apply(update);
+    }
+    return any;
+}
+
+void PlayerStats::apply(const PlayerStatsUpdate& update) {
+    if (update.token.empty()) return;
+
+    auto [it, inserted] = players_.try_emplace(update.token);
+    const std::string* key = &it->first;
+    LifetimeStats& stats = it->second;
+    if (inserted) playerCount_.store(players_.size(), std::memory_order_relaxed);
+    if (!update.name.empty()) stats.name = update.name;
+
+    if (update.finishedGame) {
+        ++stats.gamesPlayed;
+        if (update.wonGame) {
+            ++stats.gamesWon;
+            gamesWon_.update(key, static_cast<double>(stats.gamesWon));
+        }
+    } else {
+        ++stats.rounds;
+        if (update.beatDeck) {
+            ++stats.deckWins;
+            deckWins_.update(key, static_cast<double>(stats.deckWins));
+        }
+        if (update.net != 0 || inserted) {
+            if (!inserted) byNet_.erase({stats.net, key});
+            stats.net += update.net;
+            byNet_.insert({stats.net, key});
+        }
+    }
+
+    changed_ = true;
+    unsaved_ = true;
+    updates_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PlayerStats::publish() {
+    auto ranking = [this](const std::vector<std::pair<double, const std::string*>>& entries) {
+        nlohmann::json list = nlohmann::json::array();
+        for (const auto& [score, key] : entries) {
+            // Tokens are credentials; only names leave the server
+            list.push_back({{"name", players_.at(*key).name}, {"value", score}});
+        }
+        return list;
+    };
+
+    std::vector<std::pair<double, const std::string*>> topNet;
+    for (auto it = byNet_.begin(); it != byNet_.end() && topNet.size() < options_.leaderboardSize; ++it) {
+        topNet.push_back(*it);
+    }
+
+    auto body = std::make_shared<const std::string>(nlohmann::json{
+        {"updatedAt", std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count()},
+        {"players", players_.size()},
+        {"gamesWon", ranking(gamesWon_.entries())},
+        {"netProfit", ranking(topNet)},
+        {"deckWins", ranking(deckWins_.entries())}
+    }.dump());
+
+    {
+        std::lock_guard<std::mutex> lock(leaderboardMutex_);
+        leaderboard_ = std::move(body);
+    }
+    changed_ = false;
+    lastPublish_ = std::chrono::steady_clock::now();
+}
+
+void PlayerStats::load() {
+    if (options_.path.empty()) return;
+    std::ifstream file(options_.path, std::ios::binary);
+    if (!file) return;
+
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    const std::string data = contents.str();
+    if (data.size() < sizeof(kStatsMagic) || std::memcmp(data.data(), kStatsMagic, sizeof(kStatsMagic)) != 0) {
+        std::cerr << "Player stats: " << options_.path << " is not a stats file, starting empty" << std::endl;
+        return;
+    }
+
+    try {
+        BinaryReader in(data.data() + sizeof(kStatsMagic), data.size() - sizeof(kStatsMagic));
+        uint64_t count = in.u64();
+        for (uint64_t i = 0; i < count; ++i) {
+            std::string token = in.str();
+            LifetimeStats stats;
+            stats.name = in.str();
+            stats.rounds = in.u64();
+            stats.gamesPlayed = in.u64();
+            stats.gamesWon = in.u64();
+            stats.deckWins = in.u64();
+            stats.net = in.f64();
+
+            auto [it, inserted] = players_.emplace(std::move(token), std::move(stats));
+            if (!inserted) continue;
+            const std::string* key = &it->first;
+            if (it->second.gamesWon) gamesWon_.update(key, static_cast<double>(it->second.gamesWon));
+            if (it->second.deckWins) deckWins_.update(key, static_cast<double>(it->second.deckWins));
+            byNet_.insert({it->second.net, key});
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Player stats: " << options_.path << " is truncated (" << e.what()
+                  << "), kept " << players_.size() << " players" << std::endl;
+    }
+    playerCount_.store(players_.size(), std::memory_order_relaxed);
+    std::cout << "Loaded lifetime stats for " << players_.size() << " players" << std::endl;
+}
+
+void PlayerStats::save() {
+    unsaved_ = false;
+    lastSave_ = std::chrono::steady_clock::now();
+    if (options_.path.empty()) return;
+
+    std::string buffer(kStatsMagic, sizeof(kStatsMagic));
+    BinaryWriter out(buffer);
+    out.u64(players_.size());
+    for (const auto& [token, stats] : players_) {
+        out.str(token);
+        out.str(stats.name);
+        out.u64(stats.rounds);
+        out.u64(stats.gamesPlayed);
+        out.u64(stats.gamesWon);
+        out.u64(stats.deckWins);
+        out.f64(stats.net);
+    }
+
+    // Replace the file atomically so a crash leaves the previous save
+    std::string tmpPath = options_.path + ".tmp";
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    bool ok = fd >= 0 && writeAll(fd, buffer.data(), buffer.size()) && ::fdatasync(fd) == 0;
+    if (fd >= 0) ::close(fd);
+    if (ok) ok = ::rename(tmpPath.c_str(), options_.path.c_str()) == 0;
+
+    if (!ok) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+        std::cerr << "Player stats: save to " << options_.path << " failed: " << std::strerror(errno) << std::endl;
+    }
+}
+
+void PlayerStats::renderPrometheus(std::string& out) const {
+    metrics::appendMetricHeader(out, "guts_player_stats_players", "Players with lifetime stats", "gauge");
+    metrics::appendSample(out, "guts_player_stats_players", "", static_cast<double>(playerCount_.load(std::memory_order_relaxed)));
+    metrics::appendMetricHeader(out, "guts_player_stats_updates_total", "Round and game results applied to lifetime stats", "counter");
+    metrics::appendSample(out, "guts_player_stats_updates_total", "", static_cast<double>(updates_.load(std::memory_order_relaxed)));
+    metrics::appendMetricHeader(out, "guts_player_stats_dropped_total", "Updates dropped because the aggregator fell behind", "counter");
+    metrics::appendSample(out, "guts_player_stats_dropped_total", "", static_cast<double>(dropped_.load(std::memory_order_relaxed)));
+    metrics::appendMetricHeader(out, "guts_player_stats_errors_total", "Failed lifetime stats saves", "counter");
+    metrics::appendSample(out, "guts_player_stats_errors_total", "", static_cast<double>(errors_.load(std::memory_order_relaxed)));
+    metrics::appendMetricHeader(out, "guts_player_stats_queue_depth", "Updates waiting for the aggregator", "gauge");
+    metrics::appendSample(out, "guts_player_stats_queue_depth", "", static_cast<double>(queued_.load(std::memory_order_relaxed)));
+}
+
+} // namespace guts
@@ -0,0 +1,59 @@
+#include "RandomSource.hpp"
+#include <openssl/rand.h>
+#include <stdexcept>
+#include <cstdio>
+
+namespace guts {
+
+uint64_t RandomSource::uniform(uint64_t bound) {
+    if (bound <= 1) return 0;
+
+    // Reject the top partial range so every residue is equally likely
+    uint64_t limit = UINT64_MAX - UINT64_MAX % bound;
+    uint64_t value;
+    do {
+        value = next();
+    } while (value >= limit);
+    return value % bound;
+}
+
+uint64_t SecureRandom::next() {
+    if (used_ == buffer_.size()) {
+        if (RAND_bytes(reinterpret_cast<unsigned char*>(buffer_.data()),
+                       static_cast<int>(sizeof(buffer_))) != 1) {
+            throw std::runtime_error("Failed to generate secure random bytes");
+        }
+        used_ = 0;
+    }
+    return buffer_[used_++];
+}
+
+uint64_t deriveSeed(uint64_t seed, const std::string& key) {
+    // FNV-1a over the key, then a splitmix64 finalizer
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+
+    uint64_t z = seed ^ hash;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+std::string generateUUID(RandomSource& source) {
+    uint64_t part1 = source.next();
+    uint64_t part2 = source.next();
+
+    char buffer[37];
+    snprintf(buffer, sizeof(buffer), "%08llx-%04llx-%04llx-%04llx-%012llx",
+        (unsigned long long)((part1 >> 32) & 0xFFFFFFFF),
+        (unsigned long long)((part1 >> 16) & 0xFFFF),
+        (unsigned long long)(part1 & 0xFFFF),
+        (unsigned long long)((part2 >> 48) & 0xFFFF),
+        (unsigned long long)(part2 & 0xFFFFFFFFFFFF));
+
+    return std::string(buffer);
+}
+
+} // namespace guts
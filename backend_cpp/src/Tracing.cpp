@@ -0,0 +1,136 @@
+#include "Tracing.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+
+namespace guts {
+namespace tracing {
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    std::string roomCode;
+    int round;
+    int64_t startMicros;
+    int64_t durationMicros; // < 0 for instant events
+    double designedMs;
+    uint32_t threadIndex;
+};
+
+const Clock::time_point traceEpoch = Clock::now();
+
+std::atomic<bool> tracingEnabled{true};
+std::mutex bufferMutex;
+std::vector<TraceEvent> buffer;
+size_t capacity = 16384;
+size_t head = 0; // next slot to overwrite once the buffer is full
+
+int64_t micros(Clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(t - traceEpoch).count();
+}
+
+uint32_t threadIndex() {
+    static std::atomic<uint32_t> nextIndex{1};
+    thread_local uint32_t index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+void push(TraceEvent&& event) {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    if (capacity == 0) return;
+
+    if (buffer.size() < capacity) {
+        buffer.push_back(std::move(event));
+    } else {
+        buffer[head] = std::move(event);
+        head = (head + 1) % capacity;
+    }
+}
+
+} // namespace
+
+void setCapacity(size_t newCapacity) {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    capacity = newCapacity;
+    buffer.clear();
+    buffer.shrink_to_fit();
+    head = 0;
+    tracingEnabled.store(capacity > 0, std::memory_order_relaxed);
+}
+
+bool enabled() {
+    return tracingEnabled.load(std::memory_order_relaxed);
+}
+
+void complete(const char* name, const std::string& roomCode, int round,
+              Clock::time_point start, Clock::time_point end, double designedMs) {
+    if (!enabled()) return;
+    push({name, roomCode, round, micros(start), std::max<int64_t>(0, micros(end) - micros(start)),
+          designedMs, threadIndex()});
+}
+
+void instant(const char* name, const std::string& roomCode, int round) {
+    if (!enabled()) return;
+    push({name, roomCode, round, micros(Clock::now()), -1, -1.0, threadIndex()});
+}
+
+void renderChromeTrace(std::string& out, const std::string& roomFilter) {
+    std::vector<TraceEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        events.reserve(buffer.size());
+        // Oldest first
+        for (size_t i = 0; i < buffer.size(); ++i) {
+            const TraceEvent& event = buffer[(head + i) % buffer.size()];
+            if (roomFilter.empty() || event.roomCode == roomFilter) {
+                events.push_back(event);
+            }
+        }
+    }
+
+    // Each room becomes its own "process" so its rounds line up in one row
+    std::unordered_map<std::string, int> roomPids;
+    nlohmann::json traceEvents = nlohmann::json::array();
+
+    for (const auto& event : events) {
+        auto [it, inserted] = roomPids.emplace(event.roomCode, static_cast<int>(roomPids.size()) + 1);
+        if (inserted) {
+            traceEvents.push_back({
+                {"name", "process_name"}, {"ph", "M"}, {"pid", it->second},
+                {"args", {{"name", "room " + event.roomCode}}}
+            });
+        }
+
+        nlohmann::json args = {{"room", event.roomCode}, {"round", event.round}};
+        if (event.designedMs >= 0) {
+            args["designedMs"] = event.designedMs;
+            args["excessMs"] = static_cast<double>(event.durationMicros) / 1000.0 - event.designedMs;
+        }
+
+        nlohmann::json entry = {
+            {"name", event.name},
+            {"cat", "round"},
+            {"pid", it->second},
+            {"tid", event.threadIndex},
+            {"ts", event.startMicros},
+            {"args", std::move(args)}
+        };
+        if (event.durationMicros >= 0) {
+            entry["ph"] = "X";
+            entry["dur"] = event.durationMicros;
+        } else {
+            entry["ph"] = "i";
+            entry["s"] = "p";
+        }
+        traceEvents.push_back(std::move(entry));
+    }
+
+    out = nlohmann::json{{"traceEvents", std::move(traceEvents)}, {"displayTimeUnit", "ms"}}.dump();
+}
+
+} // namespace tracing
+} // namespace guts
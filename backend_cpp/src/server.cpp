@@ -1,106 +1,474 @@
 #include "GameManager.hpp"
+#include "TokenBucket.hpp"
+#include "Metrics.hpp"
+#include "Tracing.hpp"
+#include "LoopMonitor.hpp"
+#include "AllocAccounting.hpp"
+#include "GameCodec.hpp"
+#include "GameJournal.hpp"
+#include "HandHistory.hpp"
+#include "Capture.hpp"
+#include "PlayerStats.hpp"
+#include "Handoff.hpp"
+#include "Cluster.hpp"
+#include "AdmissionControl.hpp"
 #include <drogon/drogon.h>
 #include <drogon/WebSocketController.h>
 #include <nlohmann/json.hpp>
+#include <algorithm>
 #include <iostream>
 #include <map>
+#include <unordered_map>
+#include <array>
 #include <mutex>
 #include <memory>
+#include <vector>
+#include <thread>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <future>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 using namespace drogon;
 using json = nlohmann::json;
 
-// Global managers (initialized in main)
-static std::shared_ptr<guts::GameManager> gameManager;
-
-// WebSocket connection manager
+// WebSocket connection manager. Sockets and rooms are spread over striped
+// maps, each behind its own mutex, so shards sending to different rooms
+// rarely meet on a lock. Messages are serialized before any lock is taken
+// and sent after it is released; a lock only covers a map lookup. Bytes
+// handed to send() are counted per room so the admin view can show which
+// rooms generate the traffic.
 class WSConnectionManager {
 public:
     void addConnection(const std::string& socketId, const WebSocketConnectionPtr& conn) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        connections_[socketId] = conn;
+        SocketStripe& stripe = socketStripe(socketId);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        stripe.sockets[socketId] = SocketEntry{conn, 0, std::string()};
     }
     
     void removeConnection(const std::string& socketId) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        connections_.erase(socketId);
+        SocketStripe& stripe = socketStripe(socketId);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        stripe.sockets.erase(socketId);
     }
     
-    void sendMessage(const std::string& socketId, const std::string& event, const json& data) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = connections_.find(socketId);
-        if (it != connections_.end() && it->second) {
-            json message = {{"event", event}, {"data", data}};
+    // Any inbound frame (text, ping or pong) proves the peer is alive
+    void markAlive(const std::string& socketId) {
+        SocketStripe& stripe = socketStripe(socketId);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        auto it = stripe.sockets.find(socketId);
+        if (it != stripe.sockets.end()) {
+            it->second.missedHeartbeats = 0;
+        }
+    }
+    
+    // Called from a single periodic event-loop timer: pings every socket and
+    // closes the ones that have not answered `maxMissed` pings in a row.
+    // Closing goes through handleConnectionClosed, which marks the player
+    // inactive and auto-drops them from the current round.
+    void sweepHeartbeats(int maxMissed) {
+        std::vector<WebSocketConnectionPtr> dead;
+        std::vector<WebSocketConnectionPtr> alive;
+        for (auto& stripe : socketStripes_) {
+            std::lock_guard<std::mutex> lock(stripe.mutex);
+            for (auto& [socketId, entry] : stripe.sockets) {
+                if (!entry.conn) continue;
+                if (entry.missedHeartbeats >= maxMissed) {
+                    dead.push_back(entry.conn);
+                    continue;
+                }
+                ++entry.missedHeartbeats;
+                alive.push_back(entry.conn);
+            }
+        }
+        
+        for (const auto& conn : alive) {
             try {
-                it->second->send(message.dump());
+                conn->send("", WebSocketMessageType::Ping);
             } catch (const std::exception& e) {
-                std::cerr << "Error sending to " << socketId << ": " << e.what() << std::endl;
+                std::cerr << "Error pinging socket: " << e.what() << std::endl;
             }
         }
+        
+        for (const auto& conn : dead) {
+            auto socketIdPtr = conn->getContext<std::string>();
+            std::cout << "WebSocket heartbeat timeout: " 
+                      << (socketIdPtr ? *socketIdPtr : std::string("unknown")) << std::endl;
+            conn->forceClose();
+        }
+    }
+    
+    // Drop a connection; the client reconnects through its usual backoff
+    void closeConnection(const std::string& socketId) {
+        // Closing re-enters the manager through handleConnectionClosed
+        if (auto conn = connection(socketId)) conn->forceClose();
+    }
+    
+    void sendMessage(const std::string& socketId, const std::string& event, const json& data) {
+        guts::metrics::ScopedLatency latency(guts::metrics::Stage::Send, event);
+        std::string roomCode;
+        auto conn = connection(socketId, &roomCode);
+        if (!conn) return;
+        try {
+            deliver(conn, roomCode, event, json{{"event", event}, {"data", data}}.dump());
+        } catch (const std::exception& e) {
+            std::cerr << "Error sending to " << socketId << ": " << e.what() << std::endl;
+        }
+    }
+    
+    // sendMessage for `data` that is already serialized JSON
+    void sendRawMessage(const std::string& socketId, const std::string& event, const std::string& data) {
+        guts::metrics::ScopedLatency latency(guts::metrics::Stage::Send, event);
+        std::string roomCode;
+        auto conn = connection(socketId, &roomCode);
+        if (!conn) return;
+        try {
+            std::string eventName = json(event).dump();
+            std::string messageStr;
+            messageStr.reserve(eventName.size() + data.size() + 20);
+            messageStr += "{\"data\":";
+            messageStr += data;
+            messageStr += ",\"event\":";
+            messageStr += eventName;
+            messageStr += '}';
+            deliver(conn, roomCode, event, messageStr);
+        } catch (const std::exception& e) {
+            std::cerr << "Error sending to " << socketId << ": " << e.what() << std::endl;
+        }
     }
     
     void broadcastToRoom(const std::string& roomCode, const std::string& event, const json& data) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto roomIt = roomConnections_.find(roomCode);
-        if (roomIt == roomConnections_.end()) return;
+        guts::metrics::ScopedLatency latency(guts::metrics::Stage::Send, event);
+        std::string messageStr = json{{"event", event}, {"data", data}}.dump();
         
-        json message = {{"event", event}, {"data", data}};
-        std::string messageStr = message.dump();
+        std::vector<WebSocketConnectionPtr> members;
+        {
+            RoomStripe& stripe = roomStripe(roomCode);
+            std::lock_guard<std::mutex> lock(stripe.mutex);
+            auto roomIt = stripe.rooms.find(roomCode);
+            if (roomIt == stripe.rooms.end()) return;
+            members.reserve(roomIt->second.members.size());
+            for (const auto& [socketId, conn] : roomIt->second.members) {
+                if (conn) members.push_back(conn);
+            }
+        }
         
-        for (const auto& socketId : roomIt->second) {
-            auto connIt = connections_.find(socketId);
-            if (connIt != connections_.end() && connIt->second) {
-                try {
-                    connIt->second->send(messageStr);
-                } catch (const std::exception& e) {
-                    std::cerr << "Error broadcasting: " << e.what() << std::endl;
-                }
+        size_t recipients = 0;
+        for (const auto& conn : members) {
+            try {
+                conn->send(messageStr);
+                ++recipients;
+            } catch (const std::exception& e) {
+                std::cerr << "Error broadcasting: " << e.what() << std::endl;
             }
         }
+        guts::metrics::recordMessageOut(event, messageStr.size(), recipients);
+        recordSent(roomCode, messageStr.size() * recipients);
     }
     
+    // Bytes handed to send() for each room's sockets over the last full
+    // traffic window, for rooms with at least one socket attached
+    std::unordered_map<std::string, uint64_t> recentSentBytes() {
+        auto now = std::chrono::steady_clock::now();
+        std::unordered_map<std::string, uint64_t> sent;
+        for (auto& stripe : roomStripes_) {
+            std::lock_guard<std::mutex> lock(stripe.mutex);
+            for (auto& [roomCode, room] : stripe.rooms) {
+                room.traffic.roll(now);
+                sent.emplace(roomCode, room.traffic.previousBytes);
+            }
+        }
+        return sent;
+    }
+    
+    // Called on the socket's own loop, like leaveRoom, so one socket's
+    // room moves never race each other
     void joinRoom(const std::string& socketId, const std::string& roomCode) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        roomConnections_[roomCode].insert(socketId);
-        socketRooms_[socketId] = roomCode;
+        WebSocketConnectionPtr conn;
+        std::string previous;
+        {
+            SocketStripe& stripe = socketStripe(socketId);
+            std::lock_guard<std::mutex> lock(stripe.mutex);
+            auto it = stripe.sockets.find(socketId);
+            if (it == stripe.sockets.end()) return;
+            conn = it->second.conn;
+            previous = std::move(it->second.roomCode);
+            it->second.roomCode = roomCode;
+        }
+        if (!previous.empty() && previous != roomCode) removeMember(previous, socketId);
+        
+        RoomStripe& stripe = roomStripe(roomCode);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        stripe.rooms[roomCode].members[socketId] = std::move(conn);
+    }
+    
+    std::string roomOf(const std::string& socketId) {
+        SocketStripe& stripe = socketStripe(socketId);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        auto it = stripe.sockets.find(socketId);
+        return it != stripe.sockets.end() ? it->second.roomCode : std::string();
     }
     
     void leaveRoom(const std::string& socketId) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = socketRooms_.find(socketId);
-        if (it != socketRooms_.end()) {
-            roomConnections_[it->second].erase(socketId);
-            socketRooms_.erase(it);
+        std::string roomCode;
+        {
+            SocketStripe& stripe = socketStripe(socketId);
+            std::lock_guard<std::mutex> lock(stripe.mutex);
+            auto it = stripe.sockets.find(socketId);
+            if (it == stripe.sockets.end()) return;
+            roomCode = std::move(it->second.roomCode);
+            it->second.roomCode.clear();
         }
+        if (!roomCode.empty()) removeMember(roomCode, socketId);
     }
 
 private:
-    std::mutex mutex_;
-    std::map<std::string, WebSocketConnectionPtr> connections_;
-    std::map<std::string, std::set<std::string>> roomConnections_;
-    std::map<std::string, std::string> socketRooms_;
+    static constexpr size_t kStripes = 64;
+    static constexpr std::chrono::seconds kTrafficWindow{10};
+    
+    struct SocketEntry {
+        WebSocketConnectionPtr conn;
+        int missedHeartbeats = 0; // unanswered pings
+        std::string roomCode;
+    };
+    
+    struct SocketStripe {
+        std::mutex mutex;
+        std::unordered_map<std::string, SocketEntry> sockets;
+    };
+    
+    // Two fixed windows: bytes accumulate into the current one and the
+    // last complete one is what gets reported
+    struct TrafficWindow {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        uint64_t currentBytes = 0;
+        uint64_t previousBytes = 0;
+        
+        void roll(std::chrono::steady_clock::time_point now) {
+            if (now - start < kTrafficWindow) return;
+            // A window with nothing after it means the room went quiet
+            previousBytes = now - start < 2 * kTrafficWindow ? currentBytes : 0;
+            currentBytes = 0;
+            start = now;
+        }
+    };
+    
+    struct RoomEntry {
+        std::unordered_map<std::string, WebSocketConnectionPtr> members;
+        TrafficWindow traffic;
+    };
+    
+    struct RoomStripe {
+        std::mutex mutex;
+        std::unordered_map<std::string, RoomEntry> rooms;
+    };
+    
+    SocketStripe& socketStripe(const std::string& socketId) {
+        return socketStripes_[std::hash<std::string>{}(socketId) % kStripes];
+    }
+    
+    RoomStripe& roomStripe(const std::string& roomCode) {
+        return roomStripes_[std::hash<std::string>{}(roomCode) % kStripes];
+    }
+    
+    WebSocketConnectionPtr connection(const std::string& socketId, std::string* roomCode = nullptr) {
+        SocketStripe& stripe = socketStripe(socketId);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        auto it = stripe.sockets.find(socketId);
+        if (it == stripe.sockets.end()) return WebSocketConnectionPtr();
+        if (roomCode) *roomCode = it->second.roomCode;
+        return it->second.conn;
+    }
+    
+    void deliver(const WebSocketConnectionPtr& conn, const std::string& roomCode, const std::string& event,
+                 const std::string& messageStr) {
+        conn->send(messageStr);
+        guts::metrics::recordMessageOut(event, messageStr.size());
+        if (!roomCode.empty()) recordSent(roomCode, messageStr.size());
+    }
+    
+    void recordSent(const std::string& roomCode, size_t bytes) {
+        if (bytes == 0) return;
+        RoomStripe& stripe = roomStripe(roomCode);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        auto it = stripe.rooms.find(roomCode);
+        if (it == stripe.rooms.end()) return;
+        it->second.traffic.roll(std::chrono::steady_clock::now());
+        it->second.traffic.currentBytes += bytes;
+    }
+    
+    void removeMember(const std::string& roomCode, const std::string& socketId) {
+        RoomStripe& stripe = roomStripe(roomCode);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        auto it = stripe.rooms.find(roomCode);
+        if (it == stripe.rooms.end()) return;
+        it->second.members.erase(socketId);
+        if (it->second.members.empty()) stripe.rooms.erase(it);
+    }
+    
+    std::array<SocketStripe, kStripes> socketStripes_;
+    std::array<RoomStripe, kStripes> roomStripes_;
 };
 
 static std::shared_ptr<WSConnectionManager> wsManager;
 
-// Generate UUID
+// Paces join_room so a mass reconnect can't starve healthy rooms
+static std::shared_ptr<guts::TokenBucket> joinBucket;
+
+// Inbound traffic recorder for guts_replay; null unless GUTS_CAPTURE_FILE is set
+static std::shared_ptr<guts::CaptureRecorder> capture;
+
+// Rooms are partitioned across the IO loops by hashing the room code. Each
+// loop owns one GameManager shard, so a room's handlers, timers and fan-out
+// all run on its home loop and its state is only touched by one thread.
+class RoomRouter {
+public:
+    void addShard(std::shared_ptr<guts::GameManager> manager) {
+        shards_.push_back(std::move(manager));
+    }
+    
+    size_t shardCount() const { return shards_.size(); }
+    
+    size_t shardFor(const std::string& roomCode) const {
+        return std::hash<std::string>{}(roomCode) % shards_.size();
+    }
+    
+    guts::GameManager& shard(size_t index) { return *shards_[index]; }
+    
+    void post(size_t index, std::function<void(guts::GameManager&)> task) {
+        auto manager = shards_[index];
+        app().getIOLoop(index)->runInLoop([manager, task = std::move(task)]() {
+            try {
+                task(*manager);
+            } catch (const std::exception& e) {
+                std::cerr << "Error handling room task: " << e.what() << std::endl;
+            }
+        });
+    }
+    
+    void postToRoom(const std::string& roomCode, std::function<void(guts::GameManager&)> task) {
+        post(shardFor(roomCode), std::move(task));
+    }
+    
+    // Run `collect` on every shard's own loop and hand the per-shard results
+    // to `done` (on whichever loop answers last)
+    template <typename T>
+    void gather(std::function<T(guts::GameManager&)> collect,
+                std::function<void(std::vector<T>&&)> done) {
+        struct State {
+            std::mutex mutex;
+            std::vector<T> results;
+            size_t remaining;
+        };
+        auto state = std::make_shared<State>();
+        state->results.resize(shards_.size());
+        state->remaining = shards_.size();
+        
+        for (size_t i = 0; i < shards_.size(); ++i) {
+            post(i, [i, state, collect, done](guts::GameManager& gm) {
+                T result = collect(gm);
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->results[i] = std::move(result);
+                if (--state->remaining == 0) {
+                    done(std::move(state->results));
+                }
+            });
+        }
+    }
+
+private:
+    std::vector<std::shared_ptr<guts::GameManager>> shards_;
+};
+
+static std::shared_ptr<RoomRouter> roomRouter;
+
+static std::shared_ptr<guts::LoopMonitor> loopMonitor;
+
+// Write-ahead log of room state; null unless GUTS_JOURNAL_DIR is set
+static std::shared_ptr<guts::GameJournal> journal;
+
+// Compressed per-round records for settling disputes; null unless enabled
+static std::shared_ptr<guts::HandHistory> handHistory;
+
+// Lifetime stats by player token, behind /api/leaderboard
+static std::shared_ptr<guts::PlayerStats> playerStats;
+
+// Hands every room to the next process on this host; null unless
+// GUTS_HANDOFF_SOCKET is set
+static std::unique_ptr<guts::HandoffListener> handoffListener;
+
+// Which node owns which room codes when several processes share the load;
+// null for a single node (GUTS_CLUSTER_FILE unset)
+static std::shared_ptr<guts::ClusterMembership> cluster;
+
+// Sheds room creation, then new joins, when the process runs short of headroom
+static std::shared_ptr<guts::AdmissionController> admission;
+
+// Pin the calling thread to one core (best effort, Linux only)
+static void pinCurrentThread(size_t index) {
+#ifdef __linux__
+    unsigned int cpus = std::thread::hardware_concurrency();
+    if (cpus == 0) return;
+    
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(index % cpus, &cpuSet);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+    if (rc != 0) {
+        std::cerr << "Failed to pin IO thread " << index << ": error " << rc << std::endl;
+    }
+#else
+    (void)index;
+#endif
+}
+
+// 503 with Retry-After, for requests the server is turning away for now
+static HttpResponsePtr unavailableResponse(const std::string& message, int retryAfterSeconds) {
+    Json::Value error;
+    error["error"] = message;
+    auto resp = HttpResponse::newHttpJsonResponse(error);
+    resp->setStatusCode(k503ServiceUnavailable);
+    resp->addHeader("Retry-After", std::to_string(retryAfterSeconds));
+    return resp;
+}
+
+// Whether `data` carries the token of a player already seated in the room;
+// they are let back in however loaded the server is
+static bool isSeated(guts::GameManager& gm, const std::string& roomCode, const json& data) {
+    auto* game = gm.getGame(roomCode);
+    return game && data.contains("playerToken") && data["playerToken"].is_string() &&
+        game->findPlayerByToken(data["playerToken"].get<std::string>()) != nullptr;
+}
+
+// Admin endpoints need "Authorization: Bearer <GUTS_ADMIN_TOKEN>" and are
+// disabled entirely when no token is configured
+static std::string adminToken;
+
+static bool isAdminRequest(const HttpRequestPtr& req) {
+    if (adminToken.empty()) return false;
+    
+    const std::string& header = req->getHeader("Authorization");
+    const std::string prefix = "Bearer ";
+    if (header.size() != prefix.size() + adminToken.size() || header.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
+    
+    // Constant time over the token bytes
+    unsigned char diff = 0;
+    for (size_t i = 0; i < adminToken.size(); ++i) {
+        diff |= static_cast<unsigned char>(header[prefix.size() + i] ^ adminToken[i]);
+    }
+    return diff == 0;
+}
+
+// Socket IDs and tokens: always from the CSPRNG, one buffer per thread
 std::string generateUUID() {
-    static std::random_device rd;
-    static std::mt19937_64 gen(rd());
-    static std::uniform_int_distribution<uint64_t> dis;
-    
-    uint64_t part1 = dis(gen);
-    uint64_t part2 = dis(gen);
-    
-    char buffer[37];
-    snprintf(buffer, sizeof(buffer), "%08llx-%04llx-%04llx-%04llx-%012llx",
-        (unsigned long long)((part1 >> 32) & 0xFFFFFFFF),
-        (unsigned long long)((part1 >> 16) & 0xFFFF),
-        (unsigned long long)(part1 & 0xFFFF),
-        (unsigned long long)((part2 >> 48) & 0xFFFF),
-        (unsigned long long)(part2 & 0xFFFFFFFFFFFF));
-    
-    return std::string(buffer);
+    thread_local guts::SecureRandom secure;
+    return guts::generateUUID(secure);
 }
 
 // WebSocket Controller
@@ -109,42 +477,97 @@ public:
     void handleNewMessage(const WebSocketConnectionPtr& wsConnPtr,
                          std::string&& message,
                          const WebSocketMessageType& type) override {
+        auto socketIdPtr = wsConnPtr->getContext<std::string>();
+        if (!socketIdPtr) return;
+        std::string socketId = *socketIdPtr;
+        
+        wsManager->markAlive(socketId);
         if (type != WebSocketMessageType::Text) return;
         
+        guts::alloc::AllocScope allocScope("ws_receive");
+        
+        auto parseStart = std::chrono::steady_clock::now();
+        auto parseNanos = [&parseStart]() {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - parseStart).count());
+        };
+        
         try {
             auto jsonMsg = json::parse(message);
             if (!jsonMsg.contains("event")) return;
             
             std::string event = jsonMsg["event"];
+            // Captured where it is dispatched, so refused events stay out of replays
+            std::string raw = capture ? message : std::string();
+            guts::metrics::recordLatency(guts::metrics::Stage::Parse, guts::metrics::eventId(event), parseNanos());
+            guts::metrics::recordMessageIn(event, message.size());
             json eventData = jsonMsg.contains("data") ? jsonMsg["data"] : json::object();
             
-            auto socketIdPtr = wsConnPtr->getContext<std::string>();
-            if (!socketIdPtr) return;
-            std::string socketId = *socketIdPtr;
-            
             if (event == "join_room") {
-                if (eventData.contains("roomCode")) {
-                    wsManager->joinRoom(socketId, eventData["roomCode"]);
+                auto retryAfter = joinBucket->tryAcquire();
+                if (retryAfter.count() > 0) {
+                    wsManager->sendMessage(socketId, "join_throttled", {
+                        {"retryAfterMs", retryAfter.count()}
+                    });
+                    return;
                 }
-                gameManager->handleJoinRoom(socketId, eventData);
-            } else if (event == "start_game") {
-                gameManager->handleStartGame(socketId, eventData);
-            } else if (event == "set_buy_in") {
-                gameManager->handleSetBuyIn(socketId, eventData);
-            } else if (event == "player_decision") {
-                gameManager->handlePlayerDecision(socketId, eventData);
-            } else if (event == "next_round") {
-                gameManager->handleNextRound(socketId, eventData);
-            } else if (event == "leave_game") {
-                gameManager->handleLeaveGame(socketId);
-            } else if (event == "buy_back_in") {
-                gameManager->handleBuyBackIn(socketId, eventData);
-            } else if (event == "end_game") {
-                gameManager->handleEndGame(socketId);
-            } else if (event == "player_emote") {
-                gameManager->handlePlayerEmote(socketId, eventData);
+                
+                std::string roomCode;
+                if (eventData.contains("roomCode") && eventData["roomCode"].is_string()) {
+                    roomCode = eventData["roomCode"];
+                    wsManager->joinRoom(socketId, roomCode);
+                }
+                roomRouter->postToRoom(roomCode, [socketId, roomCode, eventData, raw](guts::GameManager& gm) {
+                    // Handing off: the client comes back once this process has
+                    // exited and its socket closes, landing on the new one
+                    if (gm.frozen()) {
+                        wsManager->sendMessage(socketId, "join_throttled", {{"retryAfterMs", 1000}});
+                        return;
+                    }
+                    
+                    // The code names the node that made the room
+                    if (cluster && !gm.getGame(roomCode)) {
+                        std::string owner = cluster->remoteOwner(roomCode);
+                        if (!owner.empty()) {
+                            wsManager->sendMessage(socketId, "room_moved", {
+                                {"roomCode", roomCode},
+                                {"wsUrl", guts::webSocketUrl(owner)}
+                            });
+                            return;
+                        }
+                    }
+                    if (admission->level() == guts::AdmissionController::Level::ShedJoins &&
+                        !isSeated(gm, roomCode, eventData) && !admission->admitJoin()) {
+                        wsManager->sendMessage(socketId, "join_throttled", {
+                            {"retryAfterMs", admission->retryAfterSeconds() * 1000}
+                        });
+                        return;
+                    }
+                    if (capture) capture->record(socketId, "join_room", raw);
+                    gm.handleJoinRoom(socketId, eventData);
+                });
+                return;
             }
+            
+            // Everything else runs on the home loop of the socket's room
+            roomRouter->postToRoom(wsManager->roomOf(socketId),
+                [socketId, event, eventData, raw](guts::GameManager& gm) {
+                    // A frozen room won't act on anything; reconnecting gets the
+                    // client to the process that now holds it
+                    if (gm.frozen()) {
+                        wsManager->closeConnection(socketId);
+                        return;
+                    }
+                    // join_room only goes through the throttled path above, and
+                    // only a closed socket disconnects
+                    if (event != "join_room" && event != "disconnect") {
+                        if (capture) capture->record(socketId, event, raw);
+                        gm.handleEvent(socketId, event, eventData);
+                    }
+                });
         } catch (const std::exception& e) {
+            guts::metrics::recordLatency(guts::metrics::Stage::Parse, guts::metrics::eventId("invalid"), parseNanos());
+            guts::metrics::recordMessageIn("invalid", message.size());
             std::cerr << "Error handling message: " << e.what() << std::endl;
         }
     }
@@ -154,6 +577,8 @@ public:
         std::string socketId = generateUUID();
         wsConnPtr->setContext(std::make_shared<std::string>(socketId));
         wsManager->addConnection(socketId, wsConnPtr);
+        guts::metrics::increment(guts::metrics::Counter::WsConnectionsOpened);
+        guts::metrics::adjust(guts::metrics::Gauge::ConnectedSockets, 1);
         std::cout << "WebSocket connected: " << socketId << std::endl;
     }
     
@@ -162,8 +587,15 @@ public:
         if (socketIdPtr) {
             std::string socketId = *socketIdPtr;
             std::cout << "WebSocket disconnected: " << socketId << std::endl;
+            guts::metrics::adjust(guts::metrics::Gauge::ConnectedSockets, -1);
             
-            gameManager->handleDisconnect(socketId);
+            std::string roomCode = wsManager->roomOf(socketId);
+            if (!roomCode.empty()) {
+                roomRouter->postToRoom(roomCode, [socketId](guts::GameManager& gm) {
+                    if (capture) capture->record(socketId, "disconnect", "");
+                    gm.handleDisconnect(socketId);
+                });
+            }
             wsManager->leaveRoom(socketId);
             wsManager->removeConnection(socketId);
         }
@@ -190,21 +622,231 @@ int main() {
         wsManager->broadcastToRoom(roomCode, event, data);
     };
     
-    gameManager = std::make_shared<guts::GameManager>(sendMessageCallback, broadcastCallback);
+    auto rawMessageCallback = [](const std::string& socketId,
+                                 const std::string& event,
+                                 const std::string& data) {
+        wsManager->sendRawMessage(socketId, event, data);
+    };
+    
+    // One IO loop (and one GameManager shard) per core unless overridden
+    size_t threadNum = std::getenv("GUTS_THREADS") ?
+        std::atoi(std::getenv("GUTS_THREADS")) : std::thread::hardware_concurrency();
+    if (threadNum == 0) threadNum = 1;
+    bool pinThreads = std::getenv("GUTS_PIN_THREADS") && std::string(std::getenv("GUTS_PIN_THREADS")) == "1";
+    
+    roomRouter = std::make_shared<RoomRouter>();
+    for (size_t i = 0; i < threadNum; ++i) {
+        auto scheduleCallback = [i](double delaySeconds, std::function<void()> task) {
+            app().getIOLoop(i)->runAfter(delaySeconds, std::move(task));
+        };
+        auto manager = std::make_shared<guts::GameManager>(
+            sendMessageCallback, broadcastCallback, scheduleCallback);
+        manager->setRawMessage(rawMessageCallback);
+        
+        if (std::getenv("DISCONNECT_GRACE_MS")) {
+            manager->setDisconnectGrace(std::chrono::milliseconds(std::atoll(std::getenv("DISCONNECT_GRACE_MS"))));
+        }
+        // Reproducible deals and room codes for replays; never in production
+        if (std::getenv("GUTS_RANDOM_SEED")) {
+            uint64_t seed = std::strtoull(std::getenv("GUTS_RANDOM_SEED"), nullptr, 10);
+            manager->setRandomSeed(guts::deriveSeed(seed, "shard-" + std::to_string(i)), seed);
+        }
+        roomRouter->addShard(manager);
+    }
+    
+    if (std::getenv("GUTS_CLUSTER_FILE")) {
+        const char* nodeId = std::getenv("GUTS_NODE_ID");
+        if (!nodeId) {
+            std::cerr << "GUTS_CLUSTER_FILE is set but GUTS_NODE_ID is not" << std::endl;
+            return 1;
+        }
+        try {
+            cluster = std::make_shared<guts::ClusterMembership>(std::getenv("GUTS_CLUSTER_FILE"), nodeId);
+        } catch (const std::exception& e) {
+            std::cerr << "Cluster: " << e.what() << std::endl;
+            return 1;
+        }
+        std::cout << "Cluster node " << nodeId << " of " << cluster->nodeCount()
+                  << ", room codes start with " << cluster->codePrefix() << std::endl;
+    }
+    
+    // Hot restart: pull the rooms from the process being replaced before
+    // anything else reads shared files, since it flushes them on the way out
+    const char* handoffPath = std::getenv("GUTS_HANDOFF_SOCKET");
+    guts::HandoffClient handoffClient;
+    std::vector<guts::RoomImage> handedRooms;
+    bool handedOver = handoffPath && handoffClient.pull(handoffPath, handedRooms);
+    
+    if (std::getenv("GUTS_CAPTURE_FILE")) {
+        double captureMaxMb = std::getenv("GUTS_CAPTURE_MAX_MB") ? std::atof(std::getenv("GUTS_CAPTURE_MAX_MB")) : 1024.0;
+        capture = std::make_shared<guts::CaptureRecorder>(std::getenv("GUTS_CAPTURE_FILE"),
+            static_cast<uint64_t>(captureMaxMb * 1024 * 1024));
+        std::cout << "Capturing inbound traffic to " << std::getenv("GUTS_CAPTURE_FILE") << std::endl;
+    }
+    
+    if (std::getenv("GUTS_HAND_HISTORY_DIR")) {
+        guts::HandHistory::Options historyOptions;
+        historyOptions.directory = std::getenv("GUTS_HAND_HISTORY_DIR");
+        historyOptions.segmentBytes = std::getenv("GUTS_HAND_HISTORY_SEGMENT_MB") ?
+            static_cast<uint64_t>(std::atof(std::getenv("GUTS_HAND_HISTORY_SEGMENT_MB")) * 1024 * 1024) : 64ull << 20;
+        historyOptions.segmentSeconds = std::getenv("GUTS_HAND_HISTORY_SEGMENT_SEC") ?
+            std::atof(std::getenv("GUTS_HAND_HISTORY_SEGMENT_SEC")) : 3600.0;
+        handHistory = std::make_shared<guts::HandHistory>(historyOptions);
+        handHistory->start();
+        
+        for (size_t i = 0; i < threadNum; ++i) {
+            roomRouter->shard(i).setHandHistory([](guts::HandRecord&& record) {
+                handHistory->record(std::move(record));
+            });
+        }
+    }
+    
+    guts::PlayerStats::Options statsOptions;
+    statsOptions.path = std::getenv("GUTS_PLAYER_STATS_FILE") ? std::getenv("GUTS_PLAYER_STATS_FILE") : "";
+    statsOptions.leaderboardSize = std::getenv("GUTS_LEADERBOARD_SIZE") ?
+        static_cast<size_t>(std::atoi(std::getenv("GUTS_LEADERBOARD_SIZE"))) : 10;
+    playerStats = std::make_shared<guts::PlayerStats>(statsOptions);
+    playerStats->start();
+    for (size_t i = 0; i < threadNum; ++i) {
+        roomRouter->shard(i).setPlayerStats([](guts::PlayerStatsUpdate&& update) {
+            playerStats->record(std::move(update));
+        });
+    }
+    
+    // Restore rooms from the last run before any traffic, then log changes
+    if (std::getenv("GUTS_JOURNAL_DIR")) {
+        guts::GameJournal::Options journalOptions;
+        journalOptions.directory = std::getenv("GUTS_JOURNAL_DIR");
+        journalOptions.sync = !std::getenv("GUTS_JOURNAL_SYNC") || std::string(std::getenv("GUTS_JOURNAL_SYNC")) != "0";
+        journalOptions.snapshotIntervalSeconds = std::getenv("GUTS_SNAPSHOT_INTERVAL_SEC") ?
+            std::atof(std::getenv("GUTS_SNAPSHOT_INTERVAL_SEC")) : 300.0;
+        journalOptions.snapshotLogBytes = std::getenv("GUTS_SNAPSHOT_LOG_MB") ?
+            static_cast<uint64_t>(std::atof(std::getenv("GUTS_SNAPSHOT_LOG_MB")) * 1024 * 1024) : 64ull << 20;
+        journal = std::make_shared<guts::GameJournal>(journalOptions);
+        
+        for (size_t i = 0; i < threadNum; ++i) {
+            roomRouter->shard(i).setJournal([](const std::string& roomCode, const guts::Game* game, const char* reason) {
+                journal->append(roomCode, game ? guts::encodeGame(*game) : std::string(), reason);
+            });
+        }
+        
+        auto recoverStart = std::chrono::steady_clock::now();
+        auto rooms = journal->recover();
+        if (handedOver) {
+            // The handoff is at least as new as the log
+            rooms.clear();
+        }
+        size_t restored = 0;
+        for (auto& [roomCode, blob] : rooms) {
+            try {
+                roomRouter->shard(roomRouter->shardFor(roomCode)).restoreGame(guts::decodeGame(blob));
+                ++restored;
+            } catch (const std::exception& e) {
+                std::cerr << "Skipping unreadable room " << roomCode << ": " << e.what() << std::endl;
+            }
+        }
+        journal->start();
+        
+        auto recoverMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - recoverStart).count();
+        std::cout << "Recovered " << restored << " rooms from " << journalOptions.directory
+                  << " in " << recoverMs << "ms" << std::endl;
+    }
+    
+    if (handedOver) {
+        size_t restored = 0;
+        for (auto& [roomCode, blob] : handedRooms) {
+            try {
+                roomRouter->shard(roomRouter->shardFor(roomCode)).restoreGame(guts::decodeGame(blob));
+                ++restored;
+            } catch (const std::exception& e) {
+                std::cerr << "Skipping unreadable room " << roomCode << ": " << e.what() << std::endl;
+            }
+        }
+        std::cout << "Took over " << restored << " rooms from the previous process" << std::endl;
+    }
+    
+    if (handoffPath) {
+        // Freeze every shard on its own loop, then flush what the next
+        // process will read. This process exits once that one is serving.
+        handoffListener = std::make_unique<guts::HandoffListener>(handoffPath,
+            []() {
+                std::promise<std::vector<std::vector<guts::RoomImage>>> exported;
+                auto perShard = exported.get_future();
+                roomRouter->gather<std::vector<guts::RoomImage>>(
+                    [](guts::GameManager& gm) {
+                        gm.freeze();
+                        return gm.exportRooms();
+                    },
+                    [&exported](std::vector<std::vector<guts::RoomImage>>&& rooms) {
+                        exported.set_value(std::move(rooms));
+                    });
+                
+                std::vector<guts::RoomImage> rooms;
+                for (auto& shardRooms : perShard.get()) {
+                    std::move(shardRooms.begin(), shardRooms.end(), std::back_inserter(rooms));
+                }
+                if (journal) journal->stop();
+                playerStats->stop();
+                return rooms;
+            },
+            []() {
+                app().getLoop()->queueInLoop([]() { app().quit(); });
+            });
+        handoffListener->start();
+        app().enableReusePort();
+    }
+    
+    double joinRate = std::getenv("JOIN_RATE_PER_SEC") ? std::atof(std::getenv("JOIN_RATE_PER_SEC")) : 200.0;
+    double joinBurst = std::getenv("JOIN_BURST") ? std::atof(std::getenv("JOIN_BURST")) : 400.0;
+    joinBucket = std::make_shared<guts::TokenBucket>(joinRate, joinBurst);
+    
+    // Loop lag probes; a loop is reported saturated after a few late probes
+    double loopProbeMs = std::getenv("LOOP_PROBE_INTERVAL_MS") ?
+        std::atof(std::getenv("LOOP_PROBE_INTERVAL_MS")) : 100.0;
+    double loopLagWarnMs = std::getenv("LOOP_LAG_WARN_MS") ?
+        std::atof(std::getenv("LOOP_LAG_WARN_MS")) : 50.0;
+    loopMonitor = std::make_shared<guts::LoopMonitor>(threadNum, loopProbeMs / 1000.0, loopLagWarnMs);
+    
+    // Admission limits; zero disables one
+    guts::AdmissionController::Limits admissionLimits;
+    admissionLimits.lagMs = std::getenv("GUTS_SHED_LAG_MS") ? std::atof(std::getenv("GUTS_SHED_LAG_MS")) : 100.0;
+    admissionLimits.rooms = std::getenv("GUTS_MAX_ROOMS") ?
+        static_cast<size_t>(std::atoll(std::getenv("GUTS_MAX_ROOMS"))) : 0;
+    admissionLimits.rssBytes = std::getenv("GUTS_MAX_RSS_MB") ?
+        static_cast<uint64_t>(std::atof(std::getenv("GUTS_MAX_RSS_MB")) * 1024 * 1024) : 0;
+    admissionLimits.queueDepth = std::getenv("GUTS_SHED_QUEUE_DEPTH") ?
+        static_cast<size_t>(std::atoll(std::getenv("GUTS_SHED_QUEUE_DEPTH"))) : 100000;
+    admission = std::make_shared<guts::AdmissionController>(admissionLimits);
     
     int port = std::getenv("PORT") ? std::atoi(std::getenv("PORT")) : 3001;
     std::string frontendUrl = std::getenv("FRONTEND_URL") ? 
         std::getenv("FRONTEND_URL") : "http://localhost:5173";
     
+    // Heartbeats: ping every interval, drop peers that miss maxMissed in a row
+    double heartbeatInterval = std::getenv("WS_HEARTBEAT_INTERVAL_SEC") ?
+        std::atof(std::getenv("WS_HEARTBEAT_INTERVAL_SEC")) : 5.0;
+    int heartbeatMaxMissed = std::getenv("WS_HEARTBEAT_MAX_MISSED") ?
+        std::atoi(std::getenv("WS_HEARTBEAT_MAX_MISSED")) : 3;
+    
+    adminToken = std::getenv("GUTS_ADMIN_TOKEN") ? std::getenv("GUTS_ADMIN_TOKEN") : "";
+    if (std::getenv("GUTS_TRACE_CAPACITY")) {
+        guts::tracing::setCapacity(static_cast<size_t>(std::atoll(std::getenv("GUTS_TRACE_CAPACITY"))));
+    }
+    
     std::cout << "Starting C++ GUTS server on 0.0.0.0:" << port << std::endl;
     std::cout << "Frontend URL: " << frontendUrl << std::endl;
+    std::cout << "IO threads: " << threadNum << (pinThreads ? " (pinned)" : "") << std::endl;
+    if (std::getenv("GUTS_RANDOM_SEED")) {
+        std::cout << "WARNING: GUTS_RANDOM_SEED is set, deals are predictable" << std::endl;
+    }
     
     // Configure and start Drogon
     app()
         .setLogPath("./")
         .setLogLevel(trantor::Logger::kWarn)
         .addListener("0.0.0.0", port)
-        .setThreadNum(8)
+        .setThreadNum(threadNum)
         .registerPostHandlingAdvice([](const HttpRequestPtr&, const HttpResponsePtr& resp) {
             resp->addHeader("Access-Control-Allow-Origin", "*");
             resp->addHeader("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
@@ -220,6 +862,52 @@ int main() {
             callback(HttpResponse::newHttpJsonResponse(response));
         }, {Get, Options});
     
+    app().registerHandler("/api/metrics",
+        [](const HttpRequestPtr&, std::function<void(const HttpResponsePtr&)>&& callback) {
+            // Room gauges are counted on each shard's own loop
+            roomRouter->gather<std::array<size_t, 3>>(
+                [](guts::GameManager& gm) { return gm.countRoomsByState(); },
+                [callback = std::move(callback)](std::vector<std::array<size_t, 3>>&& perShard) {
+                    std::array<size_t, 3> rooms{};
+                    for (const auto& counts : perShard) {
+                        for (size_t i = 0; i < rooms.size(); ++i) {
+                            rooms[i] += counts[i];
+                        }
+                    }
+                    
+                    std::string body;
+                    guts::metrics::appendMetricHeader(body, "guts_rooms", "Live rooms by game state", "gauge");
+                    for (size_t i = 0; i < rooms.size(); ++i) {
+                        guts::metrics::appendSample(body, "guts_rooms",
+                            std::string("state=\"") + guts::getGameStateName(static_cast<guts::GameState>(i)) + "\"",
+                            static_cast<double>(rooms[i]));
+                    }
+                    guts::metrics::renderPrometheus(body);
+                    loopMonitor->renderPrometheus(body);
+                    admission->renderPrometheus(body);
+                    if (journal) journal->renderPrometheus(body);
+                    if (handHistory) handHistory->renderPrometheus(body);
+                    playerStats->renderPrometheus(body);
+                    guts::alloc::renderPrometheus(body);
+                    
+                    auto resp = HttpResponse::newHttpResponse();
+                    resp->setContentTypeString("text/plain; version=0.0.4");
+                    resp->setBody(std::move(body));
+                    callback(resp);
+                });
+        }, {Get});
+    
+    // Top players from the last published snapshot; never touches the stats
+    app().registerHandler("/api/leaderboard",
+        [](const HttpRequestPtr&, std::function<void(const HttpResponsePtr&)>&& callback) {
+            auto body = playerStats->leaderboard();
+            auto resp = HttpResponse::newHttpResponse();
+            resp->setContentTypeCode(CT_APPLICATION_JSON);
+            resp->addHeader("Cache-Control", "public, max-age=1");
+            resp->setBody(body ? *body : std::string("{}"));
+            callback(resp);
+        }, {Get, Options});
+    
     app().registerHandler("/api/game/create",
         [](const HttpRequestPtr& req, std::function<void(const HttpResponsePtr&)>&& callback) {
             // Handle OPTIONS preflight
@@ -230,14 +918,36 @@ int main() {
                 return;
             }
             
-            std::string roomCode = gameManager->generateRoomCode();
-            std::string hostToken = generateUUID();
-            gameManager->createGame(roomCode, hostToken);
+            if (!admission->admitCreate()) {
+                callback(unavailableResponse("Server busy, try again shortly", admission->retryAfterSeconds()));
+                return;
+            }
             
-            Json::Value response;
-            response["roomCode"] = roomCode;
-            response["hostToken"] = hostToken;
-            callback(HttpResponse::newHttpJsonResponse(response));
+            // Spread new rooms round-robin, minting a code that hashes to the
+            // chosen shard so the room's home loop is the one creating it
+            static std::atomic<size_t> nextShard{0};
+            size_t shard = nextShard.fetch_add(1) % roomRouter->shardCount();
+            
+            roomRouter->post(shard, [shard, callback = std::move(callback)](guts::GameManager& gm) {
+                if (gm.frozen()) {
+                    callback(unavailableResponse("Server restarting", 1));
+                    return;
+                }
+                std::string roomCode = gm.generateRoomCode([shard](const std::string& code) {
+                    return roomRouter->shardFor(code) == shard;
+                }, cluster ? cluster->codePrefix() : std::string());
+                std::string hostToken = generateUUID();
+                gm.createGame(roomCode, hostToken);
+                if (capture) {
+                    capture->record("", "create_room", json{{"roomCode", roomCode}, {"hostToken", hostToken}}.dump());
+                }
+                
+                Json::Value response;
+                response["roomCode"] = roomCode;
+                response["hostToken"] = hostToken;
+                if (cluster) response["wsUrl"] = cluster->selfWebSocketUrl();
+                callback(HttpResponse::newHttpJsonResponse(response));
+            });
         }, {Post, Options});
     
     app().registerHandler("/api/game/join",
@@ -260,50 +970,265 @@ int main() {
                 return;
             }
             
+            // Every HTTP join seats a new player
+            if (!admission->admitJoin()) {
+                callback(unavailableResponse("Server busy, try again shortly", admission->retryAfterSeconds()));
+                return;
+            }
+            
             std::string roomCode = (*json)["roomCode"].asString();
-            auto* game = gameManager->getGame(roomCode);
+            roomRouter->postToRoom(roomCode, [roomCode, callback = std::move(callback)](guts::GameManager& gm) {
+                if (gm.frozen()) {
+                    callback(unavailableResponse("Server restarting", 1));
+                    return;
+                }
+                auto* game = gm.getGame(roomCode);
+                
+                if (!game && cluster) {
+                    // The owner answers for its own rooms, with its own URL
+                    std::string owner = cluster->remoteOwner(roomCode);
+                    if (!owner.empty()) {
+                        callback(HttpResponse::newRedirectionResponse(owner + "/api/game/join", k307TemporaryRedirect));
+                        return;
+                    }
+                }
+                
+                if (!game) {
+                    Json::Value error;
+                    error["error"] = "Game not found";
+                    auto resp = HttpResponse::newHttpJsonResponse(error);
+                    resp->setStatusCode(k404NotFound);
+                    callback(resp);
+                    return;
+                }
+                
+                if (game->state != guts::GameState::LOBBY) {
+                    Json::Value error;
+                    error["error"] = "Game already started";
+                    auto resp = HttpResponse::newHttpJsonResponse(error);
+                    resp->setStatusCode(k400BadRequest);
+                    callback(resp);
+                    return;
+                }
+                
+                if (game->players.size() >= 8) {
+                    Json::Value error;
+                    error["error"] = "Game is full";
+                    auto resp = HttpResponse::newHttpJsonResponse(error);
+                    resp->setStatusCode(k400BadRequest);
+                    callback(resp);
+                    return;
+                }
+                
+                Json::Value response;
+                response["playerToken"] = generateUUID();
+                response["roomCode"] = roomCode;
+                if (cluster) response["wsUrl"] = cluster->selfWebSocketUrl();
+                callback(HttpResponse::newHttpJsonResponse(response));
+            });
+        }, {Post, Options});
+    
+    // Admission signals. The level is re-evaluated on the main loop, never
+    // on a game loop; the room count comes from the shards separately so a
+    // lagging shard can't hold the evaluation back.
+    static std::atomic<size_t> roomTotal{0};
+    app().getLoop()->runEvery(0.5, []() {
+        static std::atomic<bool> counting{false};
+        if (!counting.exchange(true)) {
+            roomRouter->gather<size_t>(
+                [](guts::GameManager& gm) { return gm.roomCount(); },
+                [](std::vector<size_t>&& counts) {
+                    size_t total = 0;
+                    for (size_t count : counts) total += count;
+                    roomTotal = total;
+                    counting = false;
+                });
+        }
+        
+        guts::AdmissionController::Signals signals;
+        signals.lagMs = loopMonitor->maxLagMs();
+        signals.rooms = roomTotal;
+        signals.rssBytes = guts::AdmissionController::residentBytes();
+        signals.queueDepth = playerStats->queueDepth();
+        if (journal) signals.queueDepth += journal->queueDepth();
+        if (handHistory) signals.queueDepth += handHistory->queueDepth();
+        admission->update(signals);
+    });
+    
+    // Membership changes are picked up without a restart
+    if (cluster) {
+        app().getLoop()->runEvery(5.0, []() {
+            cluster->reload();
+        });
+    }
+    
+    // One sweep timer for all sockets instead of a timer per connection
+    if (heartbeatInterval > 0 && heartbeatMaxMissed > 0) {
+        app().getLoop()->runEvery(heartbeatInterval, [heartbeatMaxMissed]() {
+            wsManager->sweepHeartbeats(heartbeatMaxMissed);
+        });
+    }
+    
+    // Round lifecycle trace, loadable in chrome://tracing or Perfetto
+    app().registerHandler("/api/admin/trace",
+        [](const HttpRequestPtr& req, std::function<void(const HttpResponsePtr&)>&& callback) {
+            // Preflights carry no credentials; answer them before the check
+            if (req->method() == Options) {
+                auto resp = HttpResponse::newHttpResponse();
+                resp->setStatusCode(k200OK);
+                callback(resp);
+                return;
+            }
             
-            if (!game) {
+            if (!isAdminRequest(req)) {
                 Json::Value error;
-                error["error"] = "Game not found";
+                error["error"] = "Forbidden";
                 auto resp = HttpResponse::newHttpJsonResponse(error);
-                resp->setStatusCode(k404NotFound);
+                resp->setStatusCode(k403Forbidden);
                 callback(resp);
                 return;
             }
             
-            if (game->state != guts::GameState::LOBBY) {
-                Json::Value error;
-                error["error"] = "Game already started";
-                auto resp = HttpResponse::newHttpJsonResponse(error);
-                resp->setStatusCode(k400BadRequest);
+            std::string body;
+            guts::tracing::renderChromeTrace(body, req->getParameter("room"));
+            
+            auto resp = HttpResponse::newHttpResponse();
+            resp->setContentTypeCode(CT_APPLICATION_JSON);
+            resp->setBody(std::move(body));
+            callback(resp);
+        }, {Get, Options});
+    
+    // Every room with its memory estimate, largest first. Each shard summarizes
+    // its own rooms on its loop; sorting and rendering happen on the main loop.
+    app().registerHandler("/api/admin/rooms",
+        [](const HttpRequestPtr& req, std::function<void(const HttpResponsePtr&)>&& callback) {
+            // Preflights carry no credentials; answer them before the check
+            if (req->method() == Options) {
+                auto resp = HttpResponse::newHttpResponse();
+                resp->setStatusCode(k200OK);
                 callback(resp);
                 return;
             }
             
-            if (game->players.size() >= 8) {
+            if (!isAdminRequest(req)) {
                 Json::Value error;
-                error["error"] = "Game is full";
+                error["error"] = "Forbidden";
                 auto resp = HttpResponse::newHttpJsonResponse(error);
-                resp->setStatusCode(k400BadRequest);
+                resp->setStatusCode(k403Forbidden);
                 callback(resp);
                 return;
             }
             
-            Json::Value response;
-            response["playerToken"] = generateUUID();
-            response["roomCode"] = roomCode;
-            callback(HttpResponse::newHttpJsonResponse(response));
-        }, {Post, Options});
+            std::string limitParam = req->getParameter("limit");
+            size_t limit = limitParam.empty() ? 500 : static_cast<size_t>(std::atoll(limitParam.c_str()));
+            
+            roomRouter->gather<std::vector<guts::RoomSummary>>(
+                [](guts::GameManager& gm) { return gm.summarizeRooms(); },
+                [limit, callback = std::move(callback)](std::vector<std::vector<guts::RoomSummary>>&& perShard) mutable {
+                    app().getLoop()->queueInLoop([limit, callback = std::move(callback),
+                                                  perShard = std::move(perShard)]() {
+                        auto sentBytes = wsManager->recentSentBytes();
+                        std::vector<const guts::RoomSummary*> rooms;
+                        size_t hibernated = 0, totalBytes = 0;
+                        for (const auto& shardRooms : perShard) {
+                            for (const auto& room : shardRooms) {
+                                rooms.push_back(&room);
+                                if (room.hibernated) ++hibernated;
+                                totalBytes += room.totalBytes();
+                            }
+                        }
+                        std::sort(rooms.begin(), rooms.end(), [](const auto* a, const auto* b) {
+                            return a->totalBytes() > b->totalBytes();
+                        });
+                        
+                        auto now = std::chrono::system_clock::now();
+                        json list = json::array();
+                        for (size_t i = 0; i < rooms.size() && i < limit; ++i) {
+                            const guts::RoomSummary& room = *rooms[i];
+                            auto sent = sentBytes.find(room.roomCode);
+                            list.push_back({
+                                {"roomCode", room.roomCode},
+                                {"state", guts::getGameStateName(room.state)},
+                                {"round", room.round},
+                                {"players", room.players},
+                                {"connected", room.connected},
+                                {"pot", room.pot},
+                                {"lastActivity", std::chrono::duration_cast<std::chrono::milliseconds>(
+                                    room.lastActivity.time_since_epoch()).count()},
+                                {"idleSeconds", std::chrono::duration_cast<std::chrono::seconds>(
+                                    now - room.lastActivity).count()},
+                                {"hibernated", room.hibernated},
+                                {"pendingTimers", room.pendingTimers},
+                                {"bytesSentLast10s", sent != sentBytes.end() ? sent->second : 0},
+                                {"memory", {
+                                    {"game", room.gameBytes},
+                                    {"timers", room.timerBytes},
+                                    {"eventLog", room.eventLogBytes},
+                                    {"total", room.totalBytes()}
+                                }}
+                            });
+                        }
+                        
+                        auto resp = HttpResponse::newHttpResponse();
+                        resp->setContentTypeCode(CT_APPLICATION_JSON);
+                        resp->setBody(json{
+                            {"rooms", rooms.size()},
+                            {"hibernated", hibernated},
+                            {"estimatedBytes", totalBytes},
+                            {"listed", std::move(list)}
+                        }.dump());
+                        callback(resp);
+                    });
+                });
+        }, {Get, Options});
     
-    // Cleanup thread
-    std::thread([&]() {
-        while (true) {
-            std::this_thread::sleep_for(std::chrono::minutes(5));
-            gameManager->cleanupAbandonedGames();
+    // Latency quantiles in /api/metrics cover one merge window
+    double latencyWindow = std::getenv("METRICS_LATENCY_WINDOW_SEC") ?
+        std::atof(std::getenv("METRICS_LATENCY_WINDOW_SEC")) : 10.0;
+    app().getLoop()->runEvery(latencyWindow > 0 ? latencyWindow : 10.0, []() {
+        guts::metrics::mergeLatencies();
+    });
+    
+    // Rooms nobody has touched for this long are kept encoded until rejoined; 0 disables
+    double hibernateAfter = std::getenv("GUTS_HIBERNATE_AFTER_SEC") ?
+        std::atof(std::getenv("GUTS_HIBERNATE_AFTER_SEC")) : 60.0;
+    
+    // IO loops only exist once the app is running
+    app().registerBeginningAdvice([threadNum, pinThreads, hibernateAfter, &handoffClient]() {
+        // Listening now, so the previous process can stop accepting and exit
+        handoffClient.confirm();
+        
+        for (size_t i = 0; i < threadNum; ++i) {
+            auto* loop = app().getIOLoop(i);
+            loop->queueInLoop([i, pinThreads]() {
+                guts::metrics::setThreadLoop(i);
+                if (pinThreads) pinCurrentThread(i);
+            });
+            
+            loopMonitor->attach(i, [loop](double delaySeconds, std::function<void()> task) {
+                loop->runAfter(delaySeconds, std::move(task));
+            });
+            
+            // Each shard cleans up its own rooms on its own loop
+            loop->runEvery(300.0, [i]() {
+                roomRouter->shard(i).cleanupAbandonedGames();
+            });
+            if (hibernateAfter > 0) {
+                auto idleFor = std::chrono::seconds(static_cast<int64_t>(hibernateAfter));
+                loop->runEvery(std::max(1.0, hibernateAfter / 4), [i, idleFor]() {
+                    roomRouter->shard(i).hibernateIdleRooms(idleFor);
+                });
+            }
         }
-    }).detach();
+    });
     
     app().run();
+    
+    // Clean shutdown: flush the log and leave a fresh snapshot behind
+    if (journal) journal->stop();
+    if (handoffListener) handoffListener->stop();
+    if (handHistory) handHistory->stop();
+    playerStats->stop();
+    if (capture) capture->stop();
     return 0;
 }
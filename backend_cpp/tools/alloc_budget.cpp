@@ -0,0 +1,153 @@
+// Plays a scripted game through GameManager on a virtual clock and checks
+// the allocations each handler tag makes per call against a budget. Build
+// with -DGUTS_ALLOC_ACCOUNTING=ON; exits non-zero on a regression.
+#include "GameManager.hpp"
+#include "AllocAccounting.hpp"
+#include "VirtualScheduler.hpp"
+#include <nlohmann/json.hpp>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Average allocations per scope entry for a 4-player room, about 10% above
+// what the script measured. Lower them when an optimisation lands; raise
+// one only together with the change that needs it.
+struct Budget {
+    const char* tag;
+    double allocationsPerCall;
+};
+
+const Budget BUDGETS[] = {
+    {"join_room", 290},
+    {"set_buy_in", 280},
+    {"start_game", 370},
+    {"player_decision", 135},
+    {"next_round", 830},
+    {"wait_first_round", 830},
+    {"wait_round_started", 435},
+    {"wait_reveal", 340},
+    {"wait_holders_result", 465},
+    {"decision_tick", 2},
+};
+
+constexpr int kPlayers = 4;
+constexpr int kRounds = 6;
+
+} // namespace
+
+int main() {
+    using nlohmann::json;
+    
+    guts::VirtualScheduler scheduler;
+    std::map<std::string, int> events;
+    
+    // Serialize like the WebSocket layer does so fan-out cost is included
+    auto record = [&events](const std::string& event, const json& data) {
+        std::string wire = json{{"event", event}, {"data", data}}.dump();
+        ++events[event];
+        (void)wire;
+    };
+    
+    guts::GameManager manager(
+        [&record](const std::string&, const std::string& event, const json& data) { record(event, data); },
+        [&record](const std::string&, const std::string& event, const json& data) { record(event, data); },
+        scheduler.callback());
+    manager.setRawMessage([&events](const std::string&, const std::string& event, const std::string& data) {
+        std::string wire = "{\"data\":" + data + ",\"event\":" + json(event).dump() + "}";
+        ++events[event];
+        (void)wire;
+    });
+    // Same deals every run, so hand-dependent paths allocate the same amount
+    manager.setRandomSeed(1);
+    
+    auto before = guts::alloc::totalsByTag();
+    
+    const std::string roomCode = "BUDGET";
+    manager.createGame(roomCode, "token-0");
+    
+    std::vector<std::string> sockets;
+    for (int i = 0; i < kPlayers; ++i) {
+        sockets.push_back("socket-" + std::to_string(i));
+        manager.handleJoinRoom(sockets[i], {
+            {"roomCode", roomCode},
+            {"playerToken", "token-" + std::to_string(i)},
+            {"playerName", "Player " + std::to_string(i)}
+        });
+        manager.handleSetBuyIn(sockets[i], {{"buyInAmount", 100.0}});
+    }
+    
+    manager.handleStartGame(sockets[0], json::object());
+    
+    int roundsPlayed = 0;
+    for (int round = 1; round <= kRounds; ++round) {
+        // Deal, round_started and the first timer tick
+        scheduler.advance(round == 1 ? 3.0 : 1.0);
+        
+        // Alternate an all-drop round with a two-holder showdown
+        for (int i = 0; i < kPlayers; ++i) {
+            bool hold = round % 2 == 0 && i < 2;
+            manager.handlePlayerDecision(sockets[i], {{"decision", hold ? "hold" : "drop"}});
+        }
+        
+        scheduler.runUntilIdle();
+        ++roundsPlayed;
+        
+        if (round < kRounds) {
+            manager.handleNextRound(sockets[0], json::object());
+        }
+    }
+    
+    auto after = guts::alloc::totalsByTag();
+    
+    std::map<std::string, guts::alloc::AllocStats> delta;
+    for (const auto& entry : after) {
+        delta[entry.tag] = entry.stats;
+    }
+    for (const auto& entry : before) {
+        auto& stats = delta[entry.tag];
+        stats.scopes -= entry.stats.scopes;
+        stats.allocations -= entry.stats.allocations;
+        stats.bytes -= entry.stats.bytes;
+        stats.frees -= entry.stats.frees;
+    }
+    
+    printf("%d rounds played, %zu event types sent\n\n", roundsPlayed, events.size());
+    printf("%-22s %8s %12s %12s %10s\n", "tag", "calls", "allocs/call", "bytes/call", "budget");
+    
+    int failures = 0;
+    for (const auto& [tag, stats] : delta) {
+        if (stats.scopes == 0) continue;
+        
+        double perCall = static_cast<double>(stats.allocations) / static_cast<double>(stats.scopes);
+        double bytesPerCall = static_cast<double>(stats.bytes) / static_cast<double>(stats.scopes);
+        
+        const Budget* budget = nullptr;
+        for (const auto& b : BUDGETS) {
+            if (tag == b.tag) budget = &b;
+        }
+        
+        bool over = budget && perCall > budget->allocationsPerCall;
+        if (over) ++failures;
+        
+        printf("%-22s %8llu %12.1f %12.0f %10s%s\n", tag.c_str(),
+               static_cast<unsigned long long>(stats.scopes), perCall, bytesPerCall,
+               budget ? std::to_string(static_cast<int>(budget->allocationsPerCall)).c_str() : "-",
+               over ? "  OVER BUDGET" : "");
+    }
+    
+    if (roundsPlayed != kRounds || events["round_started"] != kRounds) {
+        fprintf(stderr, "\nScript did not play %d rounds\n", kRounds);
+        return 2;
+    }
+    
+    if (failures) {
+        fprintf(stderr, "\n%d tag(s) over their allocation budget\n", failures);
+        return 1;
+    }
+    printf("\nAll allocation budgets met\n");
+    return 0;
+}
@@ -0,0 +1,338 @@
+// Batch analytics over hand history segments: per-player aggregates and
+// statistical anomalies. Segments are memory-mapped and spread across
+// threads (largest first); each thread aggregates privately and the
+// results are merged once at the end.
+//
+//   guts_analytics [--threads=N] [--min-hands=N] [--z=X] [--players=FILE] dir|segment.ghh ...
+//
+// Players are keyed by player id, which is per seat in a room. Anomalies
+// compare each player against the whole population in the input:
+//   strong_hands   more straights-or-better than the deal rate allows
+//   hold_wins      more wins on held hands than the same hands win for
+//                  everyone else (a hint of seeing other players' cards)
+// Scores are one-sided binomial z-scores; with many players a few land
+// above 3 by chance, hence the default of 4.
+#include "Card.hpp"
+#include "HandHistory.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using json = nlohmann::json;
+
+// Hand types are 1-6; index 0 collects anything unevaluated. NOTHING rounds
+// rank hands differently, so they get their own row.
+constexpr size_t kHandTypes = 7;
+constexpr size_t kBuckets = 2 * kHandTypes;
+
+size_t bucketFor(const guts::HandRecord& record, const guts::HandRecordPlayer& player) {
+    size_t type = player.handType > 0 && player.handType < static_cast<int>(kHandTypes)
+        ? static_cast<size_t>(player.handType) : 0;
+    return (record.isNothingRound ? kHandTypes : 0) + type;
+}
+
+bool isStrong(int handType) {
+    return handType >= static_cast<int>(guts::HandType::STRAIGHT);
+}
+
+struct PlayerStats {
+    std::string name;
+    std::string roomCode;
+    uint64_t hands = 0;
+    uint64_t normalHands = 0;      // outside NOTHING rounds
+    uint64_t strongHands = 0;      // straight or better, normal rounds
+    uint64_t holds = 0;
+    uint64_t wins = 0;
+    uint64_t deckShowdowns = 0;
+    uint64_t deckWins = 0;
+    uint64_t debtHands = 0;        // finished the hand below zero
+    double net = 0;
+    std::array<uint64_t, kBuckets> dealt{};
+    std::array<uint64_t, kBuckets> held{};
+    std::array<uint64_t, kBuckets> heldWins{};
+
+    void merge(const PlayerStats& other) {
+        if (name.empty()) name = other.name;
+        if (roomCode.empty()) roomCode = other.roomCode;
+        hands += other.hands;
+        normalHands += other.normalHands;
+        strongHands += other.strongHands;
+        holds += other.holds;
+        wins += other.wins;
+        deckShowdowns += other.deckShowdowns;
+        deckWins += other.deckWins;
+        debtHands += other.debtHands;
+        net += other.net;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            dealt[i] += other.dealt[i];
+            held[i] += other.held[i];
+            heldWins[i] += other.heldWins[i];
+        }
+    }
+};
+
+// One thread's share of the input
+struct Partial {
+    std::unordered_map<std::string, PlayerStats> players;
+    uint64_t records = 0;
+    uint64_t files = 0;
+    uint64_t unreadable = 0;
+    std::array<uint64_t, 5> outcomes{}; // indexed by HandOutcome
+    int64_t firstMs = 0;
+    int64_t lastMs = 0;
+
+    void add(const guts::HandRecord& record) {
+        ++records;
+        auto outcome = static_cast<size_t>(record.outcome);
+        if (outcome < outcomes.size()) ++outcomes[outcome];
+        if (firstMs == 0 || record.timestampMs < firstMs) firstMs = record.timestampMs;
+        if (record.timestampMs > lastMs) lastMs = record.timestampMs;
+
+        bool deckShowdown = record.outcome == guts::HandOutcome::DeckWin ||
+                            record.outcome == guts::HandOutcome::DeckLoss;
+        for (const auto& player : record.players) {
+            auto& stats = players[player.id];
+            if (stats.name.empty()) {
+                stats.name = player.name;
+                stats.roomCode = record.roomCode;
+            }
+            size_t bucket = bucketFor(record, player);
+            bool holding = player.decision == "hold";
+            bool won = holding && record.winnerId == player.id;
+
+            ++stats.hands;
+            ++stats.dealt[bucket];
+            if (!record.isNothingRound) {
+                ++stats.normalHands;
+                if (isStrong(player.handType)) ++stats.strongHands;
+            }
+            if (holding) {
+                ++stats.holds;
+                ++stats.held[bucket];
+                if (won) {
+                    ++stats.wins;
+                    ++stats.heldWins[bucket];
+                }
+                if (deckShowdown) {
+                    ++stats.deckShowdowns;
+                    if (won) ++stats.deckWins;
+                }
+            }
+            if (player.balanceAfter < 0) ++stats.debtHands;
+            stats.net += player.balanceAfter - player.balanceBefore;
+        }
+    }
+};
+
+struct Anomaly {
+    std::string playerId;
+    const char* kind;
+    double z;
+    double observed;
+    double expected;
+};
+
+// One-sided z-score of `observed` successes against a sum of Bernoulli
+// trials with the given mean and variance
+double zScore(double observed, double mean, double variance) {
+    return variance > 0 ? (observed - mean) / std::sqrt(variance) : 0.0;
+}
+
+double rate(uint64_t part, uint64_t whole) {
+    return whole ? static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+}
+
+bool parseOption(const char* arg, const char* name, std::string& value) {
+    size_t length = std::strlen(name);
+    if (std::strncmp(arg, name, length) != 0 || arg[length] != '=') return false;
+    value = arg + length + 1;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t minHands = 200;
+    double threshold = 4.0;
+    std::string playersPath;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        std::string value;
+        if (parseOption(argv[i], "--threads", value)) {
+            threads = static_cast<unsigned>(std::max(1, std::atoi(value.c_str())));
+        } else if (parseOption(argv[i], "--min-hands", value)) {
+            minHands = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (parseOption(argv[i], "--z", value)) {
+            threshold = std::atof(value.c_str());
+        } else if (parseOption(argv[i], "--players", value)) {
+            playersPath = value;
+        } else if (argv[i][0] != '-') {
+            inputs.push_back(argv[i]);
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (inputs.empty()) {
+        fprintf(stderr, "Usage: %s [--threads=N] [--min-hands=N] [--z=X] [--players=FILE] dir|segment.ghh ...\n", argv[0]);
+        return 2;
+    }
+
+    // Largest first, so one big segment picked up last doesn't leave the
+    // other threads idle at the end
+    std::vector<std::pair<uintmax_t, std::string>> files;
+    for (const auto& input : inputs) {
+        std::error_code error;
+        if (std::filesystem::is_directory(input, error)) {
+            for (const auto& entry : std::filesystem::directory_iterator(input, error)) {
+                if (entry.is_regular_file() && entry.path().extension() == ".ghh") {
+                    files.emplace_back(entry.file_size(), entry.path().string());
+                }
+            }
+        } else {
+            files.emplace_back(std::filesystem::file_size(input, error), input);
+        }
+    }
+    std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    uint64_t inputBytes = 0;
+    for (const auto& file : files) inputBytes += file.first;
+
+    auto started = std::chrono::steady_clock::now();
+    std::vector<Partial> partials(std::min<size_t>(threads, std::max<size_t>(files.size(), 1)));
+    std::atomic<size_t> nextFile{0};
+    std::vector<std::thread> workers;
+    for (auto& partial : partials) {
+        workers.emplace_back([&files, &nextFile, &partial]() {
+            for (size_t i = nextFile.fetch_add(1); i < files.size(); i = nextFile.fetch_add(1)) {
+                bool ok = guts::readHandHistorySegment(files[i].second, [&partial](const guts::HandRecord& record) {
+                    partial.add(record);
+                });
+                ++(ok ? partial.files : partial.unreadable);
+                if (!ok) fprintf(stderr, "Cannot read %s\n", files[i].second.c_str());
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    Partial total;
+    for (auto& partial : partials) {
+        total.records += partial.records;
+        total.files += partial.files;
+        total.unreadable += partial.unreadable;
+        for (size_t i = 0; i < total.outcomes.size(); ++i) total.outcomes[i] += partial.outcomes[i];
+        if (partial.firstMs && (!total.firstMs || partial.firstMs < total.firstMs)) total.firstMs = partial.firstMs;
+        total.lastMs = std::max(total.lastMs, partial.lastMs);
+        if (total.players.empty()) {
+            total.players = std::move(partial.players);
+            continue;
+        }
+        for (auto& [id, stats] : partial.players) total.players[id].merge(stats);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    // Population rates that individual players are measured against
+    PlayerStats population;
+    for (const auto& entry : total.players) population.merge(entry.second);
+    double strongRate = rate(population.strongHands, population.normalHands);
+
+    std::vector<Anomaly> anomalies;
+    for (const auto& [id, stats] : total.players) {
+        if (stats.hands < minHands) continue;
+
+        double n = static_cast<double>(stats.normalHands);
+        double strongZ = zScore(static_cast<double>(stats.strongHands), n * strongRate, n * strongRate * (1 - strongRate));
+        if (strongZ >= threshold) {
+            anomalies.push_back({id, "strong_hands", strongZ, static_cast<double>(stats.strongHands), n * strongRate});
+        }
+
+        // Expected wins given exactly the hands this player chose to hold
+        double mean = 0;
+        double variance = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            double p = rate(population.heldWins[i], population.held[i]);
+            mean += static_cast<double>(stats.held[i]) * p;
+            variance += static_cast<double>(stats.held[i]) * p * (1 - p);
+        }
+        double winZ = zScore(static_cast<double>(stats.wins), mean, variance);
+        if (winZ >= threshold) {
+            anomalies.push_back({id, "hold_wins", winZ, static_cast<double>(stats.wins), mean});
+        }
+    }
+    std::sort(anomalies.begin(), anomalies.end(), [](const Anomaly& a, const Anomaly& b) { return a.z > b.z; });
+
+    printf("%llu hands from %llu segments (%.1f MB) in %.2fs on %zu threads, %.0f hands/sec\n",
+           static_cast<unsigned long long>(total.records), static_cast<unsigned long long>(total.files),
+           static_cast<double>(inputBytes) / 1e6, elapsed, partials.size(),
+           elapsed > 0 ? static_cast<double>(total.records) / elapsed : 0.0);
+    if (total.records) {
+        printf("Span %.1f days, %zu players\n", static_cast<double>(total.lastMs - total.firstMs) / 86400000.0,
+               total.players.size());
+    }
+    printf("Outcomes:");
+    for (uint8_t i = 1; i < total.outcomes.size(); ++i) {
+        printf(" %s=%llu", guts::getHandOutcomeName(static_cast<guts::HandOutcome>(i)),
+               static_cast<unsigned long long>(total.outcomes[i]));
+    }
+    printf("\n\n%-16s %10s %10s %10s\n", "hand", "dealt", "hold rate", "win|hold");
+    for (size_t i = 0; i < kBuckets; ++i) {
+        if (!population.dealt[i]) continue;
+        std::string name = i % kHandTypes ? guts::getHandTypeName(static_cast<guts::HandType>(i % kHandTypes)) : "?";
+        if (i >= kHandTypes) name += " (nothing)";
+        printf("%-16s %10llu %9.1f%% %9.1f%%\n", name.c_str(), static_cast<unsigned long long>(population.dealt[i]),
+               100 * rate(population.held[i], population.dealt[i]), 100 * rate(population.heldWins[i], population.held[i]));
+    }
+
+    printf("\n%zu anomalies (z >= %.1f, at least %llu hands)\n", anomalies.size(), threshold,
+           static_cast<unsigned long long>(minHands));
+    for (const auto& anomaly : anomalies) {
+        const auto& stats = total.players[anomaly.playerId];
+        printf("  %-12s z=%5.1f observed=%.0f expected=%.1f hands=%llu  %s \"%s\" room %s\n", anomaly.kind,
+               anomaly.z, anomaly.observed, anomaly.expected, static_cast<unsigned long long>(stats.hands),
+               anomaly.playerId.c_str(), stats.name.c_str(), stats.roomCode.c_str());
+    }
+
+    if (!playersPath.empty()) {
+        std::FILE* out = std::fopen(playersPath.c_str(), "w");
+        if (!out) {
+            fprintf(stderr, "Cannot write %s\n", playersPath.c_str());
+            return 1;
+        }
+        for (const auto& [id, stats] : total.players) {
+            json holdRates = json::object();
+            for (size_t i = 1; i < kHandTypes; ++i) {
+                if (stats.dealt[i]) {
+                    holdRates[guts::getHandTypeName(static_cast<guts::HandType>(i))] = rate(stats.held[i], stats.dealt[i]);
+                }
+            }
+            std::string line = json{
+                {"playerId", id},
+                {"name", stats.name},
+                {"roomCode", stats.roomCode},
+                {"hands", stats.hands},
+                {"holdRate", rate(stats.holds, stats.hands)},
+                {"holdRateByHand", holdRates},
+                {"deckShowdowns", stats.deckShowdowns},
+                {"deckWinRate", rate(stats.deckWins, stats.deckShowdowns)},
+                {"net", stats.net},
+                {"debtRate", rate(stats.debtHands, stats.hands)}
+            }.dump();
+            std::fprintf(out, "%s\n", line.c_str());
+        }
+        std::fclose(out);
+    }
+    return total.unreadable ? 1 : 0;
+}
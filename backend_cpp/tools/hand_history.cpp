@@ -0,0 +1,37 @@
+// Prints hand history segments as JSON lines, oldest first within a file.
+//
+//   guts_hands [--room=CODE] segment.ghh [segment.ghh ...]
+#include "HandHistory.hpp"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    std::string room;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--room=", 7) == 0) {
+            room = argv[i] + 7;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.empty()) {
+        fprintf(stderr, "Usage: %s [--room=CODE] segment.ghh [...]\n", argv[0]);
+        return 2;
+    }
+
+    int status = 0;
+    for (const auto& path : paths) {
+        bool ok = guts::readHandHistorySegment(path, [&room](const guts::HandRecord& record) {
+            if (!room.empty() && record.roomCode != room) return;
+            printf("%s\n", guts::handRecordToJson(record).dump().c_str());
+        });
+        if (!ok) {
+            fprintf(stderr, "Cannot read %s\n", path.c_str());
+            status = 1;
+        }
+    }
+    return status;
+}
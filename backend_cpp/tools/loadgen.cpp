@@ -0,0 +1,452 @@
+// WebSocket load generator speaking the /ws protocol. Creates rooms over
+// the HTTP API, connects every player as its own WebSocket client and plays
+// full games, then reports client-side end-to-end latencies.
+//
+//   guts_loadgen [--host=127.0.0.1] [--port=3001] [--rooms=100] [--players=4]
+//                [--threads=N] [--duration=60] [--ramp=50]
+//                [--decision-min-ms=200] [--decision-max-ms=1500]
+//                [--emotes-per-min=2] [--churn=0.02] [--reconnect-ms=1000]
+//                [--seed=N]
+//
+// --ramp is rooms started per second. --churn is the chance per round that
+// a non-host player drops its socket and reconnects (resuming with lastSeq).
+// Only loopback targets are accepted.
+#include "LatencyHistogram.hpp"
+#include <drogon/drogon.h>
+#include <drogon/WebSocketClient.h>
+#include <drogon/HttpClient.h>
+#include <trantor/net/EventLoopThreadPool.h>
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace drogon;
+using json = nlohmann::json;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Config {
+    std::string host = "127.0.0.1";
+    uint16_t port = 3001;
+    size_t rooms = 100;
+    int players = 4;
+    size_t threads = std::thread::hardware_concurrency();
+    double durationSeconds = 60;
+    double roomsPerSecond = 50;
+    double decisionMinMs = 200;
+    double decisionMaxMs = 1500;
+    double emotesPerMinute = 2;
+    double churn = 0.02;
+    double reconnectMs = 1000;
+    uint64_t seed = 1;
+};
+
+Config config;
+
+bool isLoopback(const std::string& host) {
+    return host == "localhost" || host == "::1" || host == "[::1]" || host.rfind("127.", 0) == 0;
+}
+
+uint64_t nanosSince(Clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+// One per event loop; only that loop's thread writes it
+struct LoopStats {
+    guts::LatencyHistogram decision; // player_decision sent -> own player_decided
+    guts::LatencyHistogram deal;     // next_round sent -> own cards_dealt
+    guts::LatencyHistogram connect;  // WebSocket connect -> room_joined
+    std::atomic<uint64_t> connected{0};
+    std::atomic<uint64_t> rounds{0};
+    std::atomic<uint64_t> messagesIn{0};
+    std::atomic<uint64_t> messagesOut{0};
+    std::atomic<uint64_t> reconnects{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> throttled{0};
+};
+
+void bump(std::atomic<uint64_t>& value, uint64_t delta = 1) {
+    value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+struct Room;
+
+// A player. All clients of a room share the room's loop, so no locking.
+struct Client {
+    Room* room = nullptr;
+    int index = 0;
+    std::string token;
+    std::string playerId;
+    WebSocketClientPtr ws;
+    bool connected = false;
+    uint64_t lastSeq = 0;
+    bool joinedOnce = false;
+    int decidedRound = -1;
+    Clock::time_point connectStartedAt;
+    Clock::time_point decisionSentAt;
+    bool awaitingDecided = false;
+
+    void connect();
+    void send(const std::string& event, const json& data);
+    void onMessage(const std::string& text);
+    void dropAndReconnect();
+};
+
+struct Room {
+    trantor::EventLoop* loop = nullptr;
+    LoopStats* stats = nullptr;
+    std::mt19937_64 rng;
+    std::string code;
+    HttpClientPtr http;
+    std::vector<std::unique_ptr<Client>> clients;
+    int joined = 0;
+    int round = 0;
+    bool started = false;
+    bool dealRequested = false;
+    Clock::time_point dealRequestedAt;
+
+    double uniform(double lo, double hi) {
+        return std::uniform_real_distribution<double>(lo, hi)(rng);
+    }
+
+    Client& host() { return *clients[0]; }
+
+    void start();
+    void requestTokens(size_t next);
+    // `timeDeal`: measure next_round -> cards_dealt (not across a game reset)
+    void hostNextRound(double delaySeconds, bool timeDeal = true);
+    void emoteTick();
+};
+
+void Client::connect() {
+    connectStartedAt = Clock::now();
+    ws = WebSocketClient::newWebSocketClient(
+        "ws://" + config.host + ":" + std::to_string(config.port), room->loop);
+
+    ws->setMessageHandler([this](std::string&& message, const WebSocketClientPtr&, const WebSocketMessageType& type) {
+        if (type == WebSocketMessageType::Text) onMessage(message);
+    });
+
+    ws->setConnectionClosedHandler([this](const WebSocketClientPtr& closed) {
+        if (closed != ws || !connected) return;
+        connected = false;
+        bump(room->stats->connected, static_cast<uint64_t>(-1));
+    });
+
+    auto req = HttpRequest::newHttpRequest();
+    req->setPath("/ws");
+    ws->connectToServer(req, [this](ReqResult result, const HttpResponsePtr&, const WebSocketClientPtr&) {
+        if (result != ReqResult::Ok) {
+            bump(room->stats->errors);
+            room->loop->runAfter(config.reconnectMs / 1000.0, [this]() { connect(); });
+            return;
+        }
+        connected = true;
+        bump(room->stats->connected);
+
+        json join = {{"roomCode", room->code}, {"playerToken", token}, {"playerName", "Load " + std::to_string(index)}};
+        if (joinedOnce) join["lastSeq"] = lastSeq;
+        send("join_room", join);
+    });
+}
+
+void Client::send(const std::string& event, const json& data) {
+    if (!connected || !ws) return;
+    auto conn = ws->getConnection();
+    if (!conn) return;
+    conn->send(json{{"event", event}, {"data", data}}.dump());
+    bump(room->stats->messagesOut);
+}
+
+void Client::dropAndReconnect() {
+    if (!connected) return;
+    bump(room->stats->reconnects);
+    connected = false;
+    bump(room->stats->connected, static_cast<uint64_t>(-1));
+    ws->stop();
+    room->loop->runAfter(config.reconnectMs / 1000.0, [this]() { connect(); });
+}
+
+void Client::onMessage(const std::string& text) {
+    bump(room->stats->messagesIn);
+
+    json message = json::parse(text, nullptr, false);
+    if (message.is_discarded() || !message.contains("event")) return;
+
+    const std::string event = message["event"].get<std::string>();
+    const json& data = message.contains("data") ? message["data"] : json::object();
+
+    if (data.contains("seq") && data["seq"].is_number_unsigned()) {
+        lastSeq = std::max(lastSeq, data["seq"].get<uint64_t>());
+    }
+
+    auto mine = [&data, this](const char* field) {
+        return data.contains(field) && data[field].is_string() && data[field].get<std::string>() == playerId;
+    };
+
+    if (event == "room_joined") {
+        playerId = data.value("playerId", "");
+        room->stats->connect.record(nanosSince(connectStartedAt));
+        if (!joinedOnce) {
+            joinedOnce = true;
+            ++room->joined;
+            if (index == 0) {
+                // Host is in; the others can join now
+                for (size_t i = 1; i < room->clients.size(); ++i) room->clients[i]->connect();
+            }
+            if (room->joined == static_cast<int>(room->clients.size()) && !room->started) {
+                room->started = true;
+                room->host().send("start_game", json::object());
+            }
+        }
+    } else if (event == "join_throttled") {
+        bump(room->stats->throttled);
+        double retry = data.value("retryAfterMs", 100) / 1000.0 + room->uniform(0, 0.25);
+        ws->stop();
+        connected = false;
+        bump(room->stats->connected, static_cast<uint64_t>(-1));
+        room->loop->runAfter(retry, [this]() { connect(); });
+    } else if (event == "round_started") {
+        int round = data.value("round", 0);
+        if (index == 0) room->round = round;
+        if (decidedRound == round) return; // replayed on resume
+
+        double delay = room->uniform(config.decisionMinMs, config.decisionMaxMs) / 1000.0;
+        room->loop->runAfter(delay, [this, round]() {
+            if (decidedRound == round || !connected) return;
+            decidedRound = round;
+            decisionSentAt = Clock::now();
+            awaitingDecided = true;
+            send("player_decision", {{"decision", room->uniform(0, 1) < 0.35 ? "hold" : "drop"}});
+        });
+
+        // Churn: drop somewhere inside the decision window
+        if (index != 0 && room->uniform(0, 1) < config.churn) {
+            room->loop->runAfter(room->uniform(0, 2.0), [this]() { dropAndReconnect(); });
+        }
+    } else if (event == "player_decided") {
+        if (awaitingDecided && mine("playerId")) {
+            awaitingDecided = false;
+            room->stats->decision.record(nanosSince(decisionSentAt));
+        }
+    } else if (event == "cards_dealt") {
+        // One sample per next_round; later, resumed and replayed deals aren't timed
+        if (room->dealRequested && mine("playerId")) {
+            room->dealRequested = false;
+            room->stats->deal.record(nanosSince(room->dealRequestedAt));
+        }
+    } else if (event == "player_in_debt") {
+        send("buy_back_in", {{"amount", 20.0}});
+    } else if (event == "error") {
+        bump(room->stats->errors);
+    }
+    
+    if (index != 0) return;
+
+    // Host drives the table
+    if (event == "all_dropped" || event == "multiple_holders_result" || event == "deck_showdown_result") {
+        bump(room->stats->rounds);
+        room->hostNextRound(1.5);
+    } else if (event == "round_blocked_debt") {
+        room->hostNextRound(1.0);
+    } else if (event == "game_ended") {
+        room->hostNextRound(2.0, false);
+    } else if (event == "game_reset") {
+        // The first round of a new game is dealt after a designed pause
+        room->dealRequested = false;
+        room->loop->runAfter(1.0, [this]() { send("start_game", json::object()); });
+    }
+}
+
+void Room::hostNextRound(double delaySeconds, bool timeDeal) {
+    loop->runAfter(delaySeconds, [this, timeDeal]() {
+        dealRequested = timeDeal;
+        dealRequestedAt = Clock::now();
+        host().send("next_round", json::object());
+    });
+}
+
+void Room::emoteTick() {
+    double chance = config.emotesPerMinute / 60.0;
+    for (auto& client : clients) {
+        if (uniform(0, 1) < chance) {
+            client->send("player_emote", {{"emoteUrl", "/emotes/emote-01.gif"}});
+        }
+    }
+}
+
+void Room::start() {
+    http = HttpClient::newHttpClient("http://" + config.host + ":" + std::to_string(config.port), loop);
+
+    auto req = HttpRequest::newHttpRequest();
+    req->setMethod(Post);
+    req->setPath("/api/game/create");
+    http->sendRequest(req, [this](ReqResult result, const HttpResponsePtr& resp) {
+        auto body = result == ReqResult::Ok && resp ? resp->getJsonObject() : nullptr;
+        if (!body || !body->isMember("roomCode")) {
+            bump(stats->errors);
+            loop->runAfter(1.0, [this]() { start(); });
+            return;
+        }
+        code = (*body)["roomCode"].asString();
+        clients[0]->token = (*body)["hostToken"].asString();
+        requestTokens(1);
+    });
+}
+
+// Join tokens one at a time, then connect the host first so it gets the seat
+void Room::requestTokens(size_t next) {
+    if (next == clients.size()) {
+        host().connect();
+        if (config.emotesPerMinute > 0) {
+            loop->runEvery(1.0, [this]() { emoteTick(); });
+        }
+        return;
+    }
+
+    Json::Value body;
+    body["roomCode"] = code;
+    body["playerName"] = "Load " + std::to_string(next);
+    auto req = HttpRequest::newHttpJsonRequest(body);
+    req->setMethod(Post);
+    req->setPath("/api/game/join");
+    http->sendRequest(req, [this, next](ReqResult result, const HttpResponsePtr& resp) {
+        auto json = result == ReqResult::Ok && resp ? resp->getJsonObject() : nullptr;
+        if (!json || !json->isMember("playerToken")) {
+            bump(stats->errors);
+            loop->runAfter(1.0, [this, next]() { requestTokens(next); });
+            return;
+        }
+        clients[next]->token = (*json)["playerToken"].asString();
+        requestTokens(next + 1);
+    });
+}
+
+bool parseOption(const char* arg, const char* name, std::string& value) {
+    size_t length = std::strlen(name);
+    if (std::strncmp(arg, name, length) != 0 || arg[length] != '=') return false;
+    value = arg + length + 1;
+    return true;
+}
+
+bool parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        std::string v;
+        if (parseOption(argv[i], "--host", v)) config.host = v;
+        else if (parseOption(argv[i], "--port", v)) config.port = static_cast<uint16_t>(std::atoi(v.c_str()));
+        else if (parseOption(argv[i], "--rooms", v)) config.rooms = std::strtoul(v.c_str(), nullptr, 10);
+        else if (parseOption(argv[i], "--players", v)) config.players = std::atoi(v.c_str());
+        else if (parseOption(argv[i], "--threads", v)) config.threads = std::strtoul(v.c_str(), nullptr, 10);
+        else if (parseOption(argv[i], "--duration", v)) config.durationSeconds = std::atof(v.c_str());
+        else if (parseOption(argv[i], "--ramp", v)) config.roomsPerSecond = std::atof(v.c_str());
+        else if (parseOption(argv[i], "--decision-min-ms", v)) config.decisionMinMs = std::atof(v.c_str());
+        else if (parseOption(argv[i], "--decision-max-ms", v)) config.decisionMaxMs = std::atof(v.c_str());
+        else if (parseOption(argv[i], "--emotes-per-min", v)) config.emotesPerMinute = std::atof(v.c_str());
+        else if (parseOption(argv[i], "--churn", v)) config.churn = std::atof(v.c_str());
+        else if (parseOption(argv[i], "--reconnect-ms", v)) config.reconnectMs = std::atof(v.c_str());
+        else if (parseOption(argv[i], "--seed", v)) config.seed = std::strtoull(v.c_str(), nullptr, 10);
+        else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return false;
+        }
+    }
+    if (config.threads == 0) config.threads = 1;
+    config.players = std::max(2, std::min(8, config.players));
+    config.decisionMaxMs = std::max(config.decisionMinMs, config.decisionMaxMs);
+    return true;
+}
+
+void printHistogram(const char* name, const guts::LatencyHistogram& h) {
+    auto ms = [](uint64_t nanos) { return static_cast<double>(nanos) / 1e6; };
+    printf("%-10s n=%-9llu p50=%8.2fms p90=%8.2fms p99=%8.2fms p99.9=%8.2fms max=%8.2fms\n", name,
+           static_cast<unsigned long long>(h.count()), ms(h.valueAtQuantile(0.5)), ms(h.valueAtQuantile(0.9)),
+           ms(h.valueAtQuantile(0.99)), ms(h.valueAtQuantile(0.999)), ms(h.max()));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (!parseArgs(argc, argv)) return 2;
+    if (!isLoopback(config.host)) {
+        fprintf(stderr, "Refusing to load %s: only loopback targets are allowed\n", config.host.c_str());
+        return 2;
+    }
+
+    printf("%zu rooms x %d players against %s:%u on %zu threads for %.0fs\n",
+           config.rooms, config.players, config.host.c_str(), config.port, config.threads, config.durationSeconds);
+
+    trantor::EventLoopThreadPool pool(config.threads, "loadgen");
+    pool.start();
+
+    std::vector<std::unique_ptr<LoopStats>> stats;
+    for (size_t i = 0; i < config.threads; ++i) stats.push_back(std::make_unique<LoopStats>());
+
+    std::vector<std::unique_ptr<Room>> rooms;
+    for (size_t r = 0; r < config.rooms; ++r) {
+        auto room = std::make_unique<Room>();
+        room->loop = pool.getLoop(r % config.threads);
+        room->stats = stats[r % config.threads].get();
+        room->rng.seed(config.seed * 1000003 + r);
+        for (int p = 0; p < config.players; ++p) {
+            auto client = std::make_unique<Client>();
+            client->room = room.get();
+            client->index = p;
+            room->clients.push_back(std::move(client));
+        }
+
+        Room* raw = room.get();
+        double startAt = config.roomsPerSecond > 0 ? static_cast<double>(r) / config.roomsPerSecond : 0.0;
+        raw->loop->runAfter(startAt, [raw]() { raw->start(); });
+        rooms.push_back(std::move(room));
+    }
+
+    auto began = Clock::now();
+    auto sum = [&stats](std::atomic<uint64_t> LoopStats::*field) {
+        uint64_t total = 0;
+        for (const auto& s : stats) total += ((*s).*field).load(std::memory_order_relaxed);
+        return total;
+    };
+
+    while (std::chrono::duration<double>(Clock::now() - began).count() < config.durationSeconds) {
+        std::this_thread::sleep_for(std::chrono::seconds(5));
+        printf("[%5.0fs] connected=%llu rounds=%llu in=%llu out=%llu reconnects=%llu errors=%llu\n",
+               std::chrono::duration<double>(Clock::now() - began).count(),
+               static_cast<unsigned long long>(sum(&LoopStats::connected)),
+               static_cast<unsigned long long>(sum(&LoopStats::rounds)),
+               static_cast<unsigned long long>(sum(&LoopStats::messagesIn)),
+               static_cast<unsigned long long>(sum(&LoopStats::messagesOut)),
+               static_cast<unsigned long long>(sum(&LoopStats::reconnects)),
+               static_cast<unsigned long long>(sum(&LoopStats::errors)));
+        fflush(stdout);
+    }
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - began).count();
+    guts::LatencyHistogram decision, deal, connect;
+    for (const auto& s : stats) {
+        decision.mergeFrom(s->decision);
+        deal.mergeFrom(s->deal);
+        connect.mergeFrom(s->connect);
+    }
+
+    printf("\nrounds: %llu (%.1f/s), messages in: %llu (%.0f/s), throttled joins: %llu\n",
+           static_cast<unsigned long long>(sum(&LoopStats::rounds)), static_cast<double>(sum(&LoopStats::rounds)) / elapsed,
+           static_cast<unsigned long long>(sum(&LoopStats::messagesIn)), static_cast<double>(sum(&LoopStats::messagesIn)) / elapsed,
+           static_cast<unsigned long long>(sum(&LoopStats::throttled)));
+    printHistogram("decision", decision);
+    printHistogram("deal", deal);
+    printHistogram("join", connect);
+
+    // Sockets are torn down with the process
+    std::fflush(stdout);
+    std::quick_exit(0);
+}
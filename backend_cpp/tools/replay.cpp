@@ -0,0 +1,207 @@
+// Feeds a capture recorded with GUTS_CAPTURE_FILE back into one in-process
+// GameManager. Game timers run on a virtual clock that follows the capture's
+// timeline, so rounds resolve relative to the recorded traffic as they did
+// live; with --seed equal to the server's GUTS_RANDOM_SEED the deals match too.
+//
+//   guts_replay capture.gcap [--speed=max|N] [--seed=N] [--room=CODE] [--out=FILE]
+//
+// --speed paces events against the wall clock (1 = as recorded, 10 = ten
+// times faster); "max" (default) runs flat out for benchmarking. --out writes
+// every outbound message as a JSON line for diffing two runs.
+#include "Capture.hpp"
+#include "GameManager.hpp"
+#include "LatencyHistogram.hpp"
+#include "VirtualScheduler.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string path;
+    double speed = 0; // 0 = as fast as possible
+    uint64_t seed = 0;
+    std::string room;
+    std::string out;
+};
+
+bool parseOption(const char* arg, const char* name, std::string& value) {
+    size_t length = std::strlen(name);
+    if (std::strncmp(arg, name, length) != 0 || arg[length] != '=') return false;
+    value = arg + length + 1;
+    return true;
+}
+
+void printHistogram(const std::string& name, const guts::LatencyHistogram& h) {
+    auto us = [](uint64_t nanos) { return static_cast<double>(nanos) / 1e3; };
+    printf("%-16s n=%-8llu p50=%8.1fus p99=%8.1fus max=%8.1fus\n", name.c_str(),
+           static_cast<unsigned long long>(h.count()), us(h.valueAtQuantile(0.5)),
+           us(h.valueAtQuantile(0.99)), us(h.max()));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string value;
+        if (parseOption(argv[i], "--speed", value)) {
+            options.speed = value == "max" ? 0 : std::atof(value.c_str());
+        } else if (parseOption(argv[i], "--seed", value)) {
+            options.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (parseOption(argv[i], "--room", value)) {
+            options.room = value;
+        } else if (parseOption(argv[i], "--out", value)) {
+            options.out = value;
+        } else if (argv[i][0] != '-' && options.path.empty()) {
+            options.path = argv[i];
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (options.path.empty()) {
+        fprintf(stderr, "Usage: %s capture.gcap [--speed=max|N] [--seed=N] [--room=CODE] [--out=FILE]\n", argv[0]);
+        return 2;
+    }
+
+    // Load everything up front so file I/O stays out of the timings
+    std::vector<guts::CaptureEvent> captured;
+    uint64_t startUnixMs = 0;
+    bool readable = guts::readCapture(options.path, startUnixMs, [&](const guts::CaptureEvent& event) {
+        captured.push_back(event);
+    });
+    if (!readable) {
+        fprintf(stderr, "Cannot read capture %s\n", options.path.c_str());
+        return 1;
+    }
+    
+    // With several IO loops records reach the file in queue order, not
+    // quite time order; virtual time must only move forward
+    std::stable_sort(captured.begin(), captured.end(), [](const auto& a, const auto& b) {
+        return a.offsetMicros < b.offsetMicros;
+    });
+    
+    std::vector<guts::CaptureEvent> events;
+    std::map<std::string, std::string> socketRooms;
+    for (auto& event : captured) {
+        if (!options.room.empty()) {
+            std::string room;
+            if (event.event == "create_room" || event.event == "join_room") {
+                json message = json::parse(event.message, nullptr, false);
+                const json& fields = event.event == "create_room" ? message : message.value("data", json::object());
+                if (fields.is_object() && fields.contains("roomCode") && fields["roomCode"].is_string()) {
+                    room = fields["roomCode"];
+                }
+                if (event.event == "join_room") socketRooms[event.socketId] = room;
+            } else {
+                auto it = socketRooms.find(event.socketId);
+                if (it != socketRooms.end()) room = it->second;
+            }
+            if (room != options.room) continue;
+        }
+        events.push_back(std::move(event));
+    }
+
+    std::unique_ptr<std::FILE, int (*)(std::FILE*)> out(nullptr, std::fclose);
+    if (!options.out.empty()) {
+        out.reset(std::fopen(options.out.c_str(), "w"));
+        if (!out) {
+            fprintf(stderr, "Cannot write %s\n", options.out.c_str());
+            return 1;
+        }
+    }
+
+    guts::VirtualScheduler scheduler;
+    uint64_t outbound = 0;
+    auto emit = [&](const std::string& target, const std::string& event, const json& data) {
+        ++outbound;
+        if (out) {
+            std::string line = json{{"t", scheduler.now()}, {"to", target}, {"event", event}, {"data", data}}.dump();
+            std::fprintf(out.get(), "%s\n", line.c_str());
+        }
+    };
+    guts::GameManager manager(emit, emit, scheduler.callback());
+    if (options.seed != 0) manager.setRandomSeed(options.seed);
+
+    std::map<std::string, guts::LatencyHistogram> handleTimes;
+    std::set<std::string> rooms;
+    uint64_t unknown = 0;
+    uint64_t malformed = 0;
+
+    auto wallStart = Clock::now();
+    auto pace = [&](double virtualSeconds) {
+        if (options.speed <= 0) return;
+        std::this_thread::sleep_until(wallStart + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(virtualSeconds / options.speed)));
+    };
+
+    for (const auto& event : events) {
+        double at = static_cast<double>(event.offsetMicros) / 1e6;
+
+        // Timers that fell due before this event run first, in order
+        while (scheduler.nextDue() <= at) {
+            pace(scheduler.nextDue());
+            scheduler.runNext();
+        }
+        pace(at);
+        scheduler.advance(std::max(0.0, at - scheduler.now()));
+
+        auto handleStart = Clock::now();
+        if (event.event == "create_room") {
+            json message = json::parse(event.message, nullptr, false);
+            if (!message.is_object() || !message.contains("roomCode") || !message.contains("hostToken")) {
+                ++malformed;
+                continue;
+            }
+            manager.createGame(message["roomCode"], message["hostToken"]);
+            rooms.insert(message["roomCode"].get<std::string>());
+        } else if (event.event == "disconnect") {
+            manager.handleEvent(event.socketId, event.event, json::object());
+        } else {
+            json message = json::parse(event.message, nullptr, false);
+            if (!message.is_object()) {
+                ++malformed;
+                continue;
+            }
+            json data = message.contains("data") ? message["data"] : json::object();
+            try {
+                if (!manager.handleEvent(event.socketId, event.event, data)) ++unknown;
+            } catch (const std::exception&) {
+                ++malformed; // same as the server, which logs and carries on
+            }
+        }
+        handleTimes[event.event].record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - handleStart).count()));
+    }
+
+    // Let rounds that were in progress at the end of the capture finish
+    size_t trailing = scheduler.runUntilIdle(1000000);
+    double wallSeconds = std::chrono::duration<double>(Clock::now() - wallStart).count();
+    double spanSeconds = events.empty() ? 0 : static_cast<double>(events.back().offsetMicros) / 1e6;
+
+    printf("Replayed %zu events (%zu rooms created) spanning %.1fs of capture in %.3fs (%.1fx)\n",
+           events.size(), rooms.size(), spanSeconds, wallSeconds,
+           wallSeconds > 0 ? spanSeconds / wallSeconds : 0.0);
+    printf("%.0f events/sec, %llu outbound messages, %zu trailing timer tasks, %llu unknown, %llu malformed\n",
+           wallSeconds > 0 ? static_cast<double>(events.size()) / wallSeconds : 0.0,
+           static_cast<unsigned long long>(outbound), trailing,
+           static_cast<unsigned long long>(unknown), static_cast<unsigned long long>(malformed));
+    for (const auto& [event, histogram] : handleTimes) {
+        printHistogram(event, histogram);
+    }
+    return 0;
+}
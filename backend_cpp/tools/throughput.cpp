@@ -0,0 +1,191 @@
+// In-process throughput ceiling for the game logic: one GameManager per
+// thread driven through fake transports on a virtual clock, so animation
+// delays collapse and no sockets are involved.
+//
+//   guts_throughput [--threads=N] [--rooms=N] [--players=N] [--rounds=N]
+//                   [--transport=count|serialize] [--seed=N]
+//
+// --rooms is per thread. "count" only counts outbound messages; "serialize"
+// also builds the wire JSON like the WebSocket layer does. Deals are seeded
+// (default 1) so runs compare like for like; --seed=0 uses SecureRandom.
+#include "GameManager.hpp"
+#include "VirtualScheduler.hpp"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+    size_t threads = std::thread::hardware_concurrency();
+    size_t rooms = 1000;
+    int players = 4;
+    int rounds = 10;
+    bool serialize = false;
+    uint64_t seed = 1;
+};
+
+struct ShardResult {
+    double setupSeconds = 0;
+    double playSeconds = 0;
+    uint64_t rounds = 0;
+    uint64_t messages = 0;   // per recipient socket
+    uint64_t bytes = 0;
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void runShard(const Options& options, size_t shardIndex, ShardResult& result) {
+    using nlohmann::json;
+    
+    guts::VirtualScheduler scheduler;
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+    const bool serialize = options.serialize;
+    const uint64_t roomSize = static_cast<uint64_t>(options.players);
+    
+    guts::GameManager manager(
+        [&, serialize](const std::string&, const std::string& event, const json& data) {
+            ++messages;
+            if (serialize) bytes += json{{"event", event}, {"data", data}}.dump().size();
+        },
+        [&, serialize, roomSize](const std::string&, const std::string& event, const json& data) {
+            messages += roomSize;
+            if (serialize) bytes += json{{"event", event}, {"data", data}}.dump().size() * roomSize;
+        },
+        scheduler.callback());
+    manager.setRawMessage([&, serialize](const std::string&, const std::string& event, const std::string& data) {
+        ++messages;
+        if (serialize) bytes += data.size() + event.size() + 20;
+    });
+    if (options.seed != 0) {
+        manager.setRandomSeed(guts::deriveSeed(options.seed, "shard-" + std::to_string(shardIndex)));
+    }
+    
+    struct Room {
+        std::string code;
+        std::vector<std::string> sockets;
+    };
+    std::vector<Room> rooms(options.rooms);
+    
+    auto setupStart = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rooms.size(); ++r) {
+        Room& room = rooms[r];
+        room.code = manager.generateRoomCode();
+        std::string prefix = std::to_string(shardIndex) + "-" + std::to_string(r) + "-";
+        manager.createGame(room.code, prefix + "0");
+        
+        for (int p = 0; p < options.players; ++p) {
+            room.sockets.push_back("socket-" + prefix + std::to_string(p));
+            manager.handleJoinRoom(room.sockets.back(), {
+                {"roomCode", room.code},
+                {"playerToken", prefix + std::to_string(p)},
+                {"playerName", "Player " + std::to_string(p)}
+            });
+        }
+        manager.handleStartGame(room.sockets[0], json::object());
+    }
+    scheduler.advance(3.0); // first deal, round_started, first tick everywhere
+    result.setupSeconds = secondsSince(setupStart);
+    
+    auto playStart = std::chrono::steady_clock::now();
+    for (int round = 0; round < options.rounds; ++round) {
+        for (const auto& room : rooms) {
+            // Keep everyone solvent so rounds never block on debt
+            guts::Game* game = manager.getGame(room.code);
+            game->pot = 0.0;
+            for (auto& p : game->players) {
+                p.balance = 1000.0;
+                p.isActive = true;
+            }
+            
+            // Rotate between an all-drop round and a two-holder showdown
+            for (size_t p = 0; p < room.sockets.size(); ++p) {
+                bool hold = round % 2 == 1 && p < 2;
+                manager.handlePlayerDecision(room.sockets[p], {{"decision", hold ? "hold" : "drop"}});
+            }
+        }
+        scheduler.runUntilIdle();
+        result.rounds += rooms.size();
+        
+        for (const auto& room : rooms) {
+            manager.handleNextRound(room.sockets[0], json::object());
+        }
+        scheduler.advance(1.0);
+    }
+    result.playSeconds = secondsSince(playStart);
+    result.messages = messages;
+    result.bytes = bytes;
+}
+
+bool parseOption(const char* arg, const char* name, std::string& value) {
+    size_t length = std::strlen(name);
+    if (std::strncmp(arg, name, length) != 0 || arg[length] != '=') return false;
+    value = arg + length + 1;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string value;
+        if (parseOption(argv[i], "--threads", value)) {
+            options.threads = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (parseOption(argv[i], "--rooms", value)) {
+            options.rooms = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (parseOption(argv[i], "--players", value)) {
+            options.players = std::atoi(value.c_str());
+        } else if (parseOption(argv[i], "--rounds", value)) {
+            options.rounds = std::atoi(value.c_str());
+        } else if (parseOption(argv[i], "--transport", value)) {
+            options.serialize = value == "serialize";
+        } else if (parseOption(argv[i], "--seed", value)) {
+            options.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (options.threads == 0) options.threads = 1;
+    if (options.players < 2) options.players = 2;
+    
+    printf("%zu threads x %zu rooms x %d players, %d rounds, transport=%s\n",
+           options.threads, options.rooms, options.players, options.rounds,
+           options.serialize ? "serialize" : "count");
+    
+    std::vector<ShardResult> results(options.threads);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < options.threads; ++i) {
+        threads.emplace_back([&options, &results, i]() { runShard(options, i, results[i]); });
+    }
+    for (auto& t : threads) t.join();
+    
+    // Per core = per shard thread, averaged
+    double roomsPerSec = 0, roundsPerSec = 0, eventsPerSec = 0, bytesPerSec = 0;
+    for (const auto& r : results) {
+        double total = r.setupSeconds + r.playSeconds;
+        roomsPerSec += static_cast<double>(options.rooms) / r.setupSeconds;
+        roundsPerSec += static_cast<double>(r.rounds) / r.playSeconds;
+        eventsPerSec += static_cast<double>(r.messages) / total;
+        bytesPerSec += static_cast<double>(r.bytes) / total;
+    }
+    double n = static_cast<double>(options.threads);
+    
+    printf("\n%-16s %14s %14s\n", "", "per core", "total");
+    printf("%-16s %14.0f %14.0f\n", "rooms/sec", roomsPerSec / n, roomsPerSec);
+    printf("%-16s %14.0f %14.0f\n", "rounds/sec", roundsPerSec / n, roundsPerSec);
+    printf("%-16s %14.0f %14.0f\n", "events/sec", eventsPerSec / n, eventsPerSec);
+    if (options.serialize) {
+        printf("%-16s %14.1f %14.1f\n", "MB/sec out", bytesPerSec / n / 1e6, bytesPerSec / 1e6);
+    }
+    return 0;
+}
@@ -0,0 +1,313 @@
+// WAN-emulation TCP proxy for putting mobile-like networks between clients
+// and guts_server. Works below WebSocket, so HTTP and /ws both pass through.
+//
+//   guts_wanproxy [--listen=127.0.0.1:3002] [--upstream=127.0.0.1:3001]
+//                 [--profile=3g|4g|lossy] [--latency-ms=N] [--jitter-ms=N]
+//                 [--bandwidth-kbps=N] [--stall-per-min=N] [--stall-ms=N]
+//                 [--drop-per-min=N] [--seed=N] [--threads=N]
+//
+// Latency and jitter apply one way, in each direction. Bandwidth (0 means
+// unlimited) is a per-connection, per-direction cap. Stalls freeze one
+// direction of a connection for --stall-ms, and drops close both sides
+// abruptly. Each connection draws from its own RNG seeded with --seed and
+// the connection's accept order, so a run can be replayed.
+#include <trantor/net/EventLoop.h>
+#include <trantor/net/EventLoopThreadPool.h>
+#include <trantor/net/TcpServer.h>
+#include <trantor/net/TcpClient.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Config {
+    std::string listenHost = "127.0.0.1";
+    uint16_t listenPort = 3002;
+    std::string upstreamHost = "127.0.0.1";
+    uint16_t upstreamPort = 3001;
+    double latencyMs = 0;
+    double jitterMs = 0;
+    double bandwidthKbps = 0;
+    double stallsPerMinute = 0;
+    double stallMs = 2000;
+    double dropsPerMinute = 0;
+    uint64_t seed = 1;
+    size_t threads = 1;
+};
+
+Config config;
+std::atomic<uint64_t> nextConnection{0};
+
+// One direction of a proxied connection. Chunks keep their order: each is
+// released no earlier than the one before it, after latency +/- jitter and
+// once the bandwidth budget allows.
+class Pipe {
+public:
+    Pipe(trantor::EventLoop* loop, std::mt19937_64& rng) : loop_(loop), rng_(rng) {}
+
+    void setTarget(const trantor::TcpConnectionPtr& target) {
+        target_ = target;
+        pump();
+    }
+
+    void push(std::string data) {
+        auto now = Clock::now();
+        double delayMs = config.latencyMs;
+        if (config.jitterMs > 0) {
+            delayMs += std::uniform_real_distribution<double>(-config.jitterMs, config.jitterMs)(rng_);
+        }
+        auto due = now + toDuration(std::max(0.0, delayMs));
+
+        if (config.bandwidthKbps > 0) {
+            double transferMs = static_cast<double>(data.size()) * 8.0 / config.bandwidthKbps;
+            linkFreeAt_ = std::max(linkFreeAt_, now) + toDuration(transferMs);
+            due = std::max(due, linkFreeAt_);
+        }
+        due = std::max({due, lastDue_, stalledUntil_});
+        lastDue_ = due;
+
+        queue_.push_back({due, std::move(data)});
+        if (queue_.size() == 1) schedulePump();
+    }
+
+    void stall(double ms) {
+        stalledUntil_ = Clock::now() + toDuration(ms);
+        for (auto& chunk : queue_) chunk.due = std::max(chunk.due, stalledUntil_);
+        lastDue_ = std::max(lastDue_, stalledUntil_);
+    }
+
+    void close() {
+        closed_ = true;
+        queue_.clear();
+    }
+
+private:
+    struct Chunk {
+        Clock::time_point due;
+        std::string data;
+    };
+
+    static Clock::duration toDuration(double ms) {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(ms));
+    }
+
+    void schedulePump() {
+        if (queue_.empty() || closed_) return;
+        double waitSeconds = std::chrono::duration<double>(queue_.front().due - Clock::now()).count();
+        std::weak_ptr<char> alive = lifetime_;
+        loop_->runAfter(std::max(0.0, waitSeconds), [this, alive]() {
+            if (alive.expired()) return;
+            pump();
+        });
+    }
+
+    void pump() {
+        if (closed_ || !target_) return;
+        auto now = Clock::now();
+        while (!queue_.empty() && queue_.front().due <= now) {
+            if (target_->connected()) target_->send(queue_.front().data);
+            queue_.pop_front();
+        }
+        schedulePump();
+    }
+
+    trantor::EventLoop* loop_;
+    std::mt19937_64& rng_;
+    trantor::TcpConnectionPtr target_;
+    std::deque<Chunk> queue_;
+    Clock::time_point lastDue_{};
+    Clock::time_point linkFreeAt_{};
+    Clock::time_point stalledUntil_{};
+    bool closed_ = false;
+    // Lets timers that outlive the pipe notice it is gone
+    std::shared_ptr<char> lifetime_ = std::make_shared<char>();
+};
+
+// A downstream client connection and its upstream leg
+class Session : public std::enable_shared_from_this<Session> {
+public:
+    Session(const trantor::TcpConnectionPtr& downstream, uint64_t id)
+        : id_(id), rng_(config.seed * 1000003 + id), loop_(downstream->getLoop()),
+          downstream_(downstream), up_(loop_, rng_), down_(loop_, rng_) {}
+
+    void start() {
+        down_.setTarget(downstream_);
+
+        upstream_ = std::make_shared<trantor::TcpClient>(
+            loop_, trantor::InetAddress(config.upstreamHost, config.upstreamPort), "wanproxy-upstream");
+
+        std::weak_ptr<Session> weak = shared_from_this();
+        upstream_->setConnectionCallback([weak](const trantor::TcpConnectionPtr& conn) {
+            auto self = weak.lock();
+            if (!self) return;
+            if (conn->connected()) {
+                self->up_.setTarget(conn);
+            } else {
+                self->close("upstream closed");
+            }
+        });
+        upstream_->setMessageCallback([weak](const trantor::TcpConnectionPtr&, trantor::MsgBuffer* buffer) {
+            auto self = weak.lock();
+            if (!self) return;
+            self->down_.push(std::string(buffer->peek(), buffer->readableBytes()));
+            buffer->retrieveAll();
+        });
+        upstream_->connect();
+
+        scheduleChaos();
+    }
+
+    void fromDownstream(trantor::MsgBuffer* buffer) {
+        up_.push(std::string(buffer->peek(), buffer->readableBytes()));
+        buffer->retrieveAll();
+    }
+
+    void close(const char* reason) {
+        if (closed_) return;
+        closed_ = true;
+        printf("[conn %llu] %s\n", static_cast<unsigned long long>(id_), reason);
+        up_.close();
+        down_.close();
+        if (downstream_->connected()) downstream_->forceClose();
+        if (upstream_ && upstream_->connection()) upstream_->connection()->forceClose();
+    }
+
+private:
+    // Stalls and drops arrive as Poisson processes: check once a second
+    void scheduleChaos() {
+        if (config.stallsPerMinute <= 0 && config.dropsPerMinute <= 0) return;
+
+        std::weak_ptr<Session> weak = shared_from_this();
+        loop_->runAfter(1.0, [weak]() {
+            auto self = weak.lock();
+            if (!self || self->closed_) return;
+
+            std::uniform_real_distribution<double> unit(0.0, 1.0);
+            if (unit(self->rng_) < config.dropsPerMinute / 60.0) {
+                self->close("dropped");
+                return;
+            }
+            if (unit(self->rng_) < config.stallsPerMinute / 60.0) {
+                bool upstream = unit(self->rng_) < 0.5;
+                (upstream ? self->up_ : self->down_).stall(config.stallMs);
+                printf("[conn %llu] %s stalled for %.0fms\n", static_cast<unsigned long long>(self->id_),
+                       upstream ? "upstream" : "downstream", config.stallMs);
+            }
+            self->scheduleChaos();
+        });
+    }
+
+    uint64_t id_;
+    std::mt19937_64 rng_;
+    trantor::EventLoop* loop_;
+    trantor::TcpConnectionPtr downstream_;
+    std::shared_ptr<trantor::TcpClient> upstream_;
+    Pipe up_;   // client -> server
+    Pipe down_; // server -> client
+    bool closed_ = false;
+};
+
+bool parseHostPort(const std::string& value, std::string& host, uint16_t& port) {
+    auto colon = value.rfind(':');
+    if (colon == std::string::npos) return false;
+    host = value.substr(0, colon);
+    port = static_cast<uint16_t>(std::atoi(value.c_str() + colon + 1));
+    return !host.empty() && port != 0;
+}
+
+void applyProfile(const std::string& name) {
+    if (name == "4g") {
+        config.latencyMs = 35; config.jitterMs = 10; config.bandwidthKbps = 12000;
+    } else if (name == "3g") {
+        config.latencyMs = 100; config.jitterMs = 40; config.bandwidthKbps = 1500;
+        config.stallsPerMinute = 0.5; config.stallMs = 1500;
+    } else if (name == "lossy") {
+        config.latencyMs = 150; config.jitterMs = 100; config.bandwidthKbps = 400;
+        config.stallsPerMinute = 2; config.stallMs = 3000; config.dropsPerMinute = 0.5;
+    } else {
+        fprintf(stderr, "Unknown profile: %s\n", name.c_str());
+        std::exit(2);
+    }
+}
+
+bool parseOption(const char* arg, const char* name, std::string& value) {
+    size_t length = std::strlen(name);
+    if (std::strncmp(arg, name, length) != 0 || arg[length] != '=') return false;
+    value = arg + length + 1;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    // Profiles first so explicit flags override them
+    for (int i = 1; i < argc; ++i) {
+        std::string v;
+        if (parseOption(argv[i], "--profile", v)) applyProfile(v);
+    }
+    for (int i = 1; i < argc; ++i) {
+        std::string v;
+        if (parseOption(argv[i], "--profile", v)) continue;
+        else if (parseOption(argv[i], "--listen", v)) {
+            if (!parseHostPort(v, config.listenHost, config.listenPort)) return 2;
+        } else if (parseOption(argv[i], "--upstream", v)) {
+            if (!parseHostPort(v, config.upstreamHost, config.upstreamPort)) return 2;
+        }
+        else if (parseOption(argv[i], "--latency-ms", v)) config.latencyMs = std::atof(v.c_str());
+        else if (parseOption(argv[i], "--jitter-ms", v)) config.jitterMs = std::atof(v.c_str());
+        else if (parseOption(argv[i], "--bandwidth-kbps", v)) config.bandwidthKbps = std::atof(v.c_str());
+        else if (parseOption(argv[i], "--stall-per-min", v)) config.stallsPerMinute = std::atof(v.c_str());
+        else if (parseOption(argv[i], "--stall-ms", v)) config.stallMs = std::atof(v.c_str());
+        else if (parseOption(argv[i], "--drop-per-min", v)) config.dropsPerMinute = std::atof(v.c_str());
+        else if (parseOption(argv[i], "--seed", v)) config.seed = std::strtoull(v.c_str(), nullptr, 10);
+        else if (parseOption(argv[i], "--threads", v)) config.threads = std::max<size_t>(1, std::strtoul(v.c_str(), nullptr, 10));
+        else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    printf("Proxying %s:%u -> %s:%u (latency %.0fms +/- %.0fms, %s, stalls %.1f/min x %.0fms, drops %.1f/min, seed %llu)\n",
+           config.listenHost.c_str(), config.listenPort, config.upstreamHost.c_str(), config.upstreamPort,
+           config.latencyMs, config.jitterMs,
+           config.bandwidthKbps > 0 ? (std::to_string(static_cast<int>(config.bandwidthKbps)) + "kbps").c_str() : "unlimited",
+           config.stallsPerMinute, config.stallMs, config.dropsPerMinute,
+           static_cast<unsigned long long>(config.seed));
+    fflush(stdout);
+
+    trantor::EventLoop loop;
+    trantor::TcpServer server(&loop, trantor::InetAddress(config.listenHost, config.listenPort), "wanproxy");
+    server.setIoLoopNum(config.threads);
+
+    server.setConnectionCallback([](const trantor::TcpConnectionPtr& conn) {
+        if (conn->connected()) {
+            auto session = std::make_shared<Session>(conn, nextConnection.fetch_add(1));
+            conn->setContext(session);
+            session->start();
+        } else if (conn->hasContext()) {
+            conn->getContext<Session>()->close("client closed");
+            conn->clearContext();
+        }
+    });
+    server.setRecvMessageCallback([](const trantor::TcpConnectionPtr& conn, trantor::MsgBuffer* buffer) {
+        if (auto session = conn->getContext<Session>()) {
+            session->fromDownstream(buffer);
+        } else {
+            buffer->retrieveAll();
+        }
+    });
+
+    server.start();
+    loop.loop();
+    return 0;
+}
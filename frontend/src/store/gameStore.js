@@ -6,9 +6,10 @@ const WS_URL = API_URL.replace('http://', 'ws://').replace('https://', 'wss://')
 // LocalStorage helpers for persistence
 const STORAGE_KEY = 'guts_game_session'
 
-const saveSessionToStorage = (roomCode, playerToken, playerName) => {
+// wsUrl is the node holding the room, so a reload reconnects straight to it
+const saveSessionToStorage = (roomCode, playerToken, playerName, wsUrl) => {
   try {
-    localStorage.setItem(STORAGE_KEY, JSON.stringify({ roomCode, playerToken, playerName }))
+    localStorage.setItem(STORAGE_KEY, JSON.stringify({ roomCode, playerToken, playerName, wsUrl }))
   } catch (e) {
     console.error('Failed to save session to localStorage:', e)
   }
@@ -34,8 +35,10 @@ const clearSessionFromStorage = () => {
 
 // WebSocket wrapper to emulate socket.io interface
 class SocketWrapper {
-  constructor(url) {
+  // fallbackUrl is used if url never answers (a remembered node may be gone)
+  constructor(url, fallbackUrl = null) {
     this.url = url
+    this.fallbackUrl = fallbackUrl
     this.ws = null
     this.connected = false
     this.reconnectDelay = 1000
@@ -45,6 +48,10 @@ class SocketWrapper {
     this.messageQueue = []
     this.shouldReconnect = true
     
+    // Last room event sequence number seen, sent on rejoin to resume
+    this.seqRoomCode = null
+    this.lastSeq = null
+    
     this.connect()
   }
   
@@ -55,6 +62,7 @@ class SocketWrapper {
       this.ws.onopen = () => {
         console.log('WebSocket connected')
         this.connected = true
+        this.fallbackUrl = null
         this.reconnectAttempts = 0
         this.reconnectDelay = 1000
         
@@ -72,6 +80,9 @@ class SocketWrapper {
       this.ws.onmessage = (event) => {
         try {
           const message = JSON.parse(event.data)
+          if (message.data && typeof message.data.seq === 'number') {
+            this.lastSeq = message.data.seq
+          }
           if (message.event && this.eventHandlers[message.event]) {
             this.eventHandlers[message.event].forEach(handler => handler(message.data))
           }
@@ -91,6 +102,10 @@ class SocketWrapper {
         // Attempt reconnection
         if (this.shouldReconnect) {
           this.reconnectAttempts++
+          if (this.fallbackUrl && this.reconnectAttempts >= 3) {
+            this.url = this.fallbackUrl
+            this.fallbackUrl = null
+          }
           const delay = Math.min(this.reconnectDelay * this.reconnectAttempts, this.maxReconnectDelay)
           setTimeout(() => this.connect(), delay)
         }
@@ -140,6 +155,32 @@ class SocketWrapper {
     }
   }
   
+  resumeSequenceFor(roomCode) {
+    // Sequence numbers are per room - start over when switching rooms
+    if (this.seqRoomCode !== roomCode) {
+      this.seqRoomCode = roomCode
+      this.lastSeq = null
+    }
+    return this.lastSeq
+  }
+  
+  // Switch to another server node (each room lives on one). Accepts the
+  // full wsUrl from the server. Returns true if the socket is reconnecting.
+  moveTo(wsUrl) {
+    const url = wsUrl.replace(/\/ws$/, '')
+    if (!url || url === this.url) return false
+    
+    this.url = url
+    this.connected = false
+    if (this.ws) {
+      // Reconnect right away instead of through the backoff in onclose
+      this.ws.onclose = null
+      this.ws.close()
+    }
+    this.connect()
+    return true
+  }
+  
   disconnect() {
     this.shouldReconnect = false
     if (this.ws) {
@@ -235,7 +276,11 @@ export const useGameStore = create((set, get) => ({
       return
     }
     
-    const socket = new SocketWrapper(WS_URL)
+    // Go back to the node that held the stored session's room
+    const stored = loadSessionFromStorage()
+    const socket = stored && stored.wsUrl
+      ? new SocketWrapper(stored.wsUrl.replace(/\/ws$/, ''), WS_URL)
+      : new SocketWrapper(WS_URL)
     
     socket.on('connect', () => {
       set({ socket, connected: true })
@@ -266,6 +311,19 @@ export const useGameStore = create((set, get) => ({
       }
     })
     
+    // The room lives on another node: reconnect there and join again
+    socket.on('room_moved', (data) => {
+      if (!get().socket.moveTo(data.wsUrl)) return
+      set({ connected: false })
+      
+      // A stored session rejoins on connect by itself
+      const session = loadSessionFromStorage()
+      const { roomCode, playerToken, playerName } = get()
+      if (roomCode === data.roomCode && playerToken && (!session || session.roomCode !== roomCode)) {
+        get().joinRoom(roomCode, playerToken, playerName)
+      }
+    })
+    
     socket.on('error', (data) => {
       // Don't show "game not found" error if we're on landing page or if it's an auto-rejoin failure
       const currentState = get()
@@ -292,16 +350,31 @@ export const useGameStore = create((set, get) => ({
       get().showNotification(data.message, 'error')
     })
     
+    socket.on('join_throttled', (data) => {
+      // Server is pacing joins (e.g. everyone reconnecting at once) - retry
+      // after the hinted delay, with jitter so we don't all come back together
+      const { roomCode, playerToken, playerName } = get()
+      if (!roomCode || !playerToken || !playerName) return
+      
+      const delay = (data.retryAfterMs || 1000) + Math.floor(Math.random() * 500)
+      setTimeout(() => {
+        const current = get()
+        if (current.roomCode === roomCode && current.playerToken === playerToken) {
+          get().joinRoom(roomCode, playerToken, playerName)
+        }
+      }, delay)
+    })
+    
     socket.on('room_joined', (data) => {
       console.log('room_joined event received:', data)
       const myPlayer = data.players.find(p => p.id === data.playerId)
       
       // IMPORTANT: Only save to localStorage on successful room join
       // This prevents double-join issues on page load
-      const { roomCode, playerToken, playerName } = get()
+      const { roomCode, playerToken, playerName, socket } = get()
       console.log('Saving session to localStorage:', roomCode, playerToken, playerName)
       if (roomCode && playerToken && playerName) {
-        saveSessionToStorage(roomCode, playerToken, playerName)
+        saveSessionToStorage(roomCode, playerToken, playerName, socket ? `${socket.url}/ws` : null)
       }
       
       set({
@@ -718,6 +791,14 @@ export const useGameStore = create((set, get) => ({
     }
   },
   
+  // Connect to the node that owns the room (multi-node deployments only)
+  useServerNode: (wsUrl) => {
+    const { socket } = get()
+    if (wsUrl && socket && socket.moveTo(wsUrl)) {
+      set({ connected: false })
+    }
+  },
+  
   createGame: async (playerName) => {
     try {
       // Clear any old session data first to prevent auto-rejoin conflicts
@@ -730,7 +811,9 @@ export const useGameStore = create((set, get) => ({
       })
       
       if (!response.ok) {
-        throw new Error(`HTTP ${response.status}: ${response.statusText}`)
+        // A busy server answers 503 with a reason worth showing
+        const error = await response.json().catch(() => ({}))
+        throw new Error(error.error || `HTTP ${response.status}: ${response.statusText}`)
       }
       
       const data = await response.json()
@@ -745,6 +828,7 @@ export const useGameStore = create((set, get) => ({
         playerToken: data.hostToken,
         playerName
       })
+      get().useServerNode(data.wsUrl)
       
       // Don't save to localStorage yet - wait until room_joined event confirms we're in
       console.log('Calling joinRoom with:', data.roomCode, data.hostToken, playerName)
@@ -778,6 +862,7 @@ export const useGameStore = create((set, get) => ({
         playerToken: data.playerToken,
         playerName
       })
+      get().useServerNode(data.wsUrl)
       
       // Don't save to localStorage yet - wait until room_joined event confirms we're in
       get().joinRoom(data.roomCode, data.playerToken, playerName)
@@ -789,15 +874,24 @@ export const useGameStore = create((set, get) => ({
   joinRoom: (roomCode, playerToken, playerName) => {
     console.log('joinRoom called:', { roomCode, playerToken, playerName })
     const { socket, connected } = get()
+    const joinPayload = () => {
+      const payload = { roomCode, playerToken, playerName }
+      const lastSeq = socket.resumeSequenceFor(roomCode)
+      if (lastSeq !== null) {
+        payload.lastSeq = lastSeq
+      }
+      return payload
+    }
+    
     if (socket && connected) {
       console.log('Emitting join_room (socket connected)')
-      socket.emit('join_room', { roomCode, playerToken, playerName })
+      socket.emit('join_room', joinPayload())
     } else if (socket) {
       console.log('Socket not connected, waiting...')
       // Socket exists but not connected yet - wait for connection
       socket.once('connect', () => {
         console.log('Emitting join_room (after connect)')
-        socket.emit('join_room', { roomCode, playerToken, playerName })
+        socket.emit('join_room', joinPayload())
       })
     }
   },
@@ -155,6 +155,33 @@ function dev_mode() {
     wait
 }
 
+# N backend processes on ports 3001.. sharing one membership file; each
+# owns part of the room-code space
+function run_cluster() {
+    local nodes="${1:-3}"
+    if [ ! -f "$BUILD_DIR/guts_server" ]; then
+        build_backend
+    fi
+    
+    local cluster_file="$(pwd)/$BUILD_DIR/cluster.txt"
+    : > "$cluster_file"
+    for i in $(seq 1 "$nodes"); do
+        echo "node-$i http://localhost:$((3000 + i))" >> "$cluster_file"
+    done
+    
+    local pids=""
+    for i in $(seq 1 "$nodes"); do
+        (cd "$BUILD_DIR" && PORT=$((3000 + i)) GUTS_NODE_ID="node-$i" GUTS_CLUSTER_FILE="$cluster_file" \
+            FRONTEND_URL=http://localhost:5173 ./guts_server) &
+        pids="$pids $!"
+    done
+    echo -e "${GREEN}$nodes nodes on ports 3001-$((3000 + nodes)), membership in $cluster_file${NC}"
+    echo -e "${YELLOW}Edit that file to add or remove nodes; servers reload it within 5s${NC}"
+    
+    trap "kill $pids 2>/dev/null; exit 0" INT
+    wait
+}
+
 function clean_build() {
     echo -e "${YELLOW}Cleaning build artifacts...${NC}"
     rm -rf "$BUILD_DIR"
@@ -171,6 +198,7 @@ function show_help() {
     echo "  run      - Run backend only (builds if needed)"
     echo "  frontend - Run frontend only"
     echo "  dev      - Run both backend and frontend (default)"
+    echo "  cluster  - Run N backend nodes sharing the room codes (default 3)"
     echo "  clean    - Clean build artifacts"
     echo "  help     - Show this help message"
     echo ""
@@ -199,6 +227,10 @@ case "${1:-dev}" in
     dev)
         dev_mode
         ;;
+    cluster)
+        print_header
+        run_cluster "$2"
+        ;;
     clean)
         print_header
         clean_build